@@ -0,0 +1,80 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+class ast_arena {
+private:
+	inline static constexpr size_t chunk_size = 64 * 1024;
+
+	struct destructor {
+		void (*destroy)(void*);
+		void* target;
+	};
+
+	void* allocate(size_t size, size_t align) {
+		size_t offset = (used + align - 1) & ~(align - 1);
+		if (chunks.empty() || offset + size > capacity) {
+			capacity = size > chunk_size ? size : chunk_size;
+			chunks.push_back(std::make_unique<std::byte[]>(capacity));
+			offset = 0;
+		}
+		used = offset + size;
+		return chunks.back().get() + offset;
+	}
+
+public:
+	ast_arena() = default;
+	ast_arena(const ast_arena&) = delete;
+	ast_arena& operator=(const ast_arena&) = delete;
+	~ast_arena() {
+		for (std::vector<destructor>::reverse_iterator itr = destructors.rbegin(); itr != destructors.rend(); ++itr) {
+			itr->destroy(itr->target);
+		}
+	}
+
+	template <class T, class... Args>
+	T* make(Args&&... args) {
+		T* node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			destructors.push_back(destructor { [](void* target) { static_cast<T*>(target)->~T(); }, node });
+		}
+		++count;
+		return node;
+	}
+
+	std::string_view copy(std::string_view text) {
+		char* data = static_cast<char*>(allocate(text.size(), 1));
+		std::memcpy(data, text.data(), text.size());
+		return std::string_view(data, text.size());
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	void adopt(ast_arena&& other) {
+		chunks.insert(chunks.begin(), std::make_move_iterator(other.chunks.begin()), std::make_move_iterator(other.chunks.end()));
+		destructors.insert(destructors.begin(), other.destructors.begin(), other.destructors.end());
+		count += other.count;
+		other.chunks.clear();
+		other.destructors.clear();
+		other.capacity = 0;
+		other.used = 0;
+		other.count = 0;
+	}
+
+private:
+	std::vector<std::unique_ptr<std::byte[]>> chunks;
+	std::vector<destructor> destructors;
+	size_t capacity { 0 };
+	size_t used { 0 };
+	size_t count { 0 };
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "parser.hpp"
+#include "context.hpp"
+
+
+class ast_cache {
+private:
+	inline static constexpr char magic[4] = { 'S', 'S', 'K', 'C' };
+	inline static constexpr uint32_t version = 4;
+	inline static constexpr uint32_t null_index = 0xFFFFFFFFu;
+
+	enum class record : unsigned char {
+		error,
+		string,
+		value,
+		call_function,
+		bin,
+		expr,
+		_return,
+		block,
+		function,
+		repeat,
+		array_reference,
+		var_definition,
+		_if,
+		_while,
+		do_while,
+		initial_list,
+		_class,
+		program,
+	};
+
+	struct header {
+		char magic[4];
+		uint32_t version;
+		uint64_t source_hash;
+		uint64_t source_size;
+		uint32_t node_count;
+		uint32_t root;
+		uint32_t function_count;
+		uint32_t reserved;
+	};
+
+	struct writer {
+		std::string_view source;
+		std::string buffer;
+		std::unordered_map<const ast_node_base*, uint32_t> indices;
+		uint32_t count;
+	};
+
+	struct reader {
+		std::string_view source;
+		const char* itr;
+		const char* end;
+		std::vector<ast_node_base*> nodes;
+		ast_arena* arena;
+		bool failed;
+	};
+
+	static void write_bytes(writer& out, const void* data, size_t size);
+	static void write_u8(writer& out, unsigned char value);
+	static void write_u32(writer& out, uint32_t value);
+	static void write_string(writer& out, std::string_view value);
+	static void write_point(writer& out, code_point point);
+	static void write_lexeme(writer& out, const lexer::lexeme& value);
+	static void write_ref(writer& out, const ast_node_base* node);
+	static void write_refs(writer& out, const std::vector<ast_node_base*>& nodes);
+	static uint32_t write_node(writer& out, const ast_node_base* node);
+
+	static bool read_bytes(reader& in, void* data, size_t size);
+	static unsigned char read_u8(reader& in);
+	static uint32_t read_u32(reader& in);
+	static std::string read_string(reader& in);
+	static code_point read_point(reader& in);
+	static lexer::lexeme read_lexeme(reader& in);
+	static ast_node_base* read_ref(reader& in);
+	static std::vector<ast_node_base*> read_refs(reader& in);
+	static ast_node_base* read_node(reader& in, ast_arena& arena);
+
+public:
+	static uint64_t hash(std::string_view source);
+	static std::string path_for(const char* source_path, uint64_t source_hash);
+	static bool store(const std::string& path, uint64_t source_hash, std::string_view source, const ast_tree& tree, const context& con);
+	static ast_tree load(const std::string& path, uint64_t source_hash, std::string_view source, context& con);
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <ostream>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include "parser.hpp"
+#include "context.hpp"
+
+
+class ast_dump {
+public:
+	enum class format {
+		xml,
+		json,
+		binary,
+	};
+
+private:
+	inline static constexpr char magic[4] = { 'S', 'S', 'K', 'A' };
+	inline static constexpr uint32_t version = 1;
+	inline static constexpr unsigned char null_node = 0xFF;
+	inline static constexpr size_t buffer_size = 64 * 1024;
+
+	class sink {
+	public:
+		explicit sink(std::ostream& out) :
+			out(out)
+		{}
+		sink(const sink&) = delete;
+		sink& operator=(const sink&) = delete;
+		~sink() {
+			flush();
+		}
+
+		void put(char c) {
+			if (used == buffer_size) {
+				flush();
+			}
+			buffer[used++] = c;
+		}
+		void put(std::string_view text) {
+			put(text.data(), text.size());
+		}
+		void put(const void* data, size_t size) {
+			if (size <= buffer_size - used) {
+				std::memcpy(buffer + used, data, size);
+				used += size;
+			} else {
+				spill(static_cast<const char*>(data), size);
+			}
+		}
+		void number(long long value);
+		void indent(int depth);
+		void flush();
+
+	private:
+		void spill(const char* data, size_t size);
+
+		std::ostream& out;
+		char buffer[buffer_size];
+		size_t used { 0 };
+	};
+
+	static const char* type_name(context::var_type type);
+	static const char* modifier_name(lexer::token_type modifier);
+	static const char* kind_name(node_kind kind);
+
+	static void xml_line(sink& out, int depth, std::string_view text);
+	static void xml_node(sink& out, const ast_node_base* node, int depth);
+	static void xml_block(sink& out, const ast_node_base* node, std::string_view name, int depth);
+
+	static void json_string(sink& out, std::string_view text);
+	static void json_key(sink& out, std::string_view key);
+	static void json_nodes(sink& out, std::string_view key, const std::vector<ast_node_base*>& nodes);
+	static void json_node(sink& out, const ast_node_base* node);
+
+	static void binary_u8(sink& out, unsigned char value);
+	static void binary_u32(sink& out, uint32_t value);
+	static void binary_string(sink& out, std::string_view text);
+	static void binary_nodes(sink& out, const std::vector<ast_node_base*>& nodes);
+	static void binary_node(sink& out, const ast_node_base* node);
+
+public:
+	static bool parse_format(std::string_view name, format& style);
+	static void write(std::ostream& out, const ast_node_base* root, format style);
+};
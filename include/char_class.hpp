@@ -0,0 +1,135 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+class char_class {
+private:
+	enum : unsigned char {
+		space = 1 << 0,
+		digit = 1 << 1,
+		alpha = 1 << 2,
+		underbar = 1 << 3,
+	};
+
+	inline static constexpr std::array<unsigned char, 256> table = [] {
+		std::array<unsigned char, 256> classes {};
+		for (int c = '0'; c <= '9'; ++c) {
+			classes[c] = digit;
+		}
+		for (int c = 'a'; c <= 'z'; ++c) {
+			classes[c] = alpha;
+			classes[c - 'a' + 'A'] = alpha;
+		}
+		classes['_'] = underbar;
+		for (unsigned char c : { ' ', '\t', '\n', '\v', '\f', '\r' }) {
+			classes[c] = space;
+		}
+		return classes;
+	}();
+
+	static unsigned char of(char c) {
+		return table[static_cast<unsigned char>(c)];
+	}
+
+	static int first_clear(uint32_t mask) {
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, ~mask);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctz(~mask);
+#endif
+	}
+
+#if defined(__AVX2__)
+	inline static constexpr int width = 32;
+	using vector = __m256i;
+	static vector load(const char* itr) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(itr)); }
+	static vector splat(char c) { return _mm256_set1_epi8(c); }
+	static vector equal(vector a, vector b) { return _mm256_cmpeq_epi8(a, b); }
+	static vector greater(vector a, vector b) { return _mm256_cmpgt_epi8(a, b); }
+	static vector both(vector a, vector b) { return _mm256_and_si256(a, b); }
+	static vector either(vector a, vector b) { return _mm256_or_si256(a, b); }
+	static uint32_t mask_of(vector v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+	inline static constexpr uint32_t full = 0xFFFFFFFFu;
+#elif defined(__SSE2__) || defined(_M_X64)
+	inline static constexpr int width = 16;
+	using vector = __m128i;
+	static vector load(const char* itr) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(itr)); }
+	static vector splat(char c) { return _mm_set1_epi8(c); }
+	static vector equal(vector a, vector b) { return _mm_cmpeq_epi8(a, b); }
+	static vector greater(vector a, vector b) { return _mm_cmpgt_epi8(a, b); }
+	static vector both(vector a, vector b) { return _mm_and_si128(a, b); }
+	static vector either(vector a, vector b) { return _mm_or_si128(a, b); }
+	static uint32_t mask_of(vector v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+	inline static constexpr uint32_t full = 0xFFFFu;
+#else
+	inline static constexpr int width = 0;
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+	static vector in_range(vector v, char low, char high) {
+		return both(greater(v, splat(low - 1)), greater(splat(high + 1), v));
+	}
+	static vector digits_of(vector v) {
+		return in_range(v, '0', '9');
+	}
+	static vector identifiers_of(vector v) {
+		vector lower = either(v, splat(0x20));
+		return either(either(digits_of(v), in_range(lower, 'a', 'z')), equal(v, splat('_')));
+	}
+	static vector spaces_of(vector v) {
+		return either(equal(v, splat(' ')), in_range(v, '\t', '\r'));
+	}
+#endif
+
+	template <unsigned char Class, class Kernel>
+	static const char* skip(const char* itr, const char* end, Kernel kernel) {
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+		while (end - itr >= width) {
+			uint32_t mask = mask_of(kernel(load(itr)));
+			if (mask != full) {
+				return itr + first_clear(mask);
+			}
+			itr += width;
+		}
+#endif
+		while (itr != end && (of(*itr) & Class)) {
+			++itr;
+		}
+		return itr;
+	}
+
+public:
+	static bool is_space(char c) {
+		return of(c) & space;
+	}
+	static bool is_digit(char c) {
+		return of(c) & digit;
+	}
+	static bool is_identifier_head(char c) {
+		return of(c) & (alpha | underbar);
+	}
+	static bool is_identifier(char c) {
+		return of(c) & (alpha | digit | underbar);
+	}
+
+	static const char* skip_digits(const char* itr, const char* end) {
+		return skip<digit>(itr, end, [](auto v) { return digits_of(v); });
+	}
+	static const char* skip_identifier(const char* itr, const char* end) {
+		return skip<alpha | digit | underbar>(itr, end, [](auto v) { return identifiers_of(v); });
+	}
+	static const char* skip_spaces(const char* itr, const char* end) {
+		return skip<space>(itr, end, [](auto v) { return spaces_of(v); });
+	}
+};
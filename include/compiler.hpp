@@ -0,0 +1,101 @@
+#pragma once
+#include "parser.hpp"
+#include "context.hpp"
+
+
+enum class opcode : unsigned char {
+	push_const,
+	load_var,
+	store_var,
+	define_var,
+	load_index,
+	store_index,
+
+	make_array,
+	make_range,
+
+	add,
+	sub,
+	mul,
+	div,
+	equal,
+	not_equal,
+	less_than,
+	greater_than,
+	less_than_or_equal,
+	greater_than_or_equal,
+
+	pop,
+	dup,
+
+	jump,
+	jump_if_false,
+	jump_if_true,
+
+	call,
+	ret,
+
+	error,
+	halt,
+};
+
+struct instruction {
+	opcode op;
+	int operand;
+};
+
+struct bytecode {
+	struct variable_reference {
+		std::string name;
+		int depth;
+		int slot;
+	};
+	struct variable_definition {
+		std::string name;
+		int depth;
+		int slot;
+		lexer::token_type modifier;
+		context::var_type type;
+		int size;
+		bool has_init;
+		bool is_list_init;
+		code_point init_point;
+	};
+	struct function_entry {
+		std::string name;
+		int entry;
+		const context::func_info* info;
+	};
+
+	std::vector<instruction> code;
+	std::vector<code_point> points;
+
+	std::vector<OBJECT> constants;
+	std::vector<variable_reference> references;
+	std::vector<std::string> messages;
+	std::vector<variable_definition> definitions;
+	std::vector<function_entry> functions;
+	std::map<std::string, int> function_index;
+};
+
+class compiler {
+private:
+	struct state {
+		bytecode& program;
+		const context& con;
+	};
+	static int emit(state& st, opcode op, int operand, code_point point);
+	static int add_reference(state& st, std::string_view name, int depth, int slot);
+	static int add_constant(state& st, OBJECT value);
+	static int add_message(state& st, const std::string& message);
+	static void patch(state& st, int at, int target);
+
+	static void compile_value(state& st, ast_node_base* node);
+	static void compile_assign(state& st, ast_node_bin* node, bool need_value);
+	static void compile_statement(state& st, ast_node_base* node);
+	static void compile_block(state& st, ast_node_block* node);
+	static void compile_var_definition(state& st, ast_node_var_definition* node);
+	static void compile_function(state& st, const std::string& name, const context::func_info& info);
+public:
+	static bytecode compile(const context& con, ast_node_base* root);
+};
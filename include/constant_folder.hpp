@@ -0,0 +1,26 @@
+#pragma once
+#include "parser.hpp"
+#include "context.hpp"
+
+
+class constant_folder {
+private:
+	struct state {
+		ast_arena& arena;
+		std::vector<ast_node_base*> constants;
+	};
+
+	static bool is_constant(const ast_node_base* node);
+	static OBJECT constant_of(const ast_node_base* node);
+	static ast_node_base* copy_constant(state& st, const ast_node_base* node, code_point point);
+	static ast_node_base* make_constant(state& st, const OBJECT& value, code_point point);
+
+	static ast_node_base* fold_value(state& st, ast_node_value* node);
+	static ast_node_base* fold_bin(state& st, ast_node_bin* node);
+	static void fold_var_definition(state& st, ast_node_var_definition* node);
+	static ast_node_base* fold_node(state& st, ast_node_base* node);
+	static void fold_function(state& st, ast_node_function* node);
+public:
+	static void fold(context& con, ast_arena& arena, ast_node_base* root);
+	static void fold(context& con, ast_arena& arena, ast_node_function* node);
+};
@@ -2,11 +2,15 @@
 
 #include "lexer.hpp"
 #include "object.hpp"
+#include "operand_stack.hpp"
 #include <list>
 #include <map>
+#include <algorithm>
 
 
 class ast_node_base;
+class ast_node_function;
+class ast_arena;
 
 struct context {
 
@@ -24,8 +28,8 @@ struct context {
 	};
 
 	struct var_info {
-		lexer::token_type modifier;
-		var_type type;
+		lexer::token_type modifier { lexer::token_type::unknown };
+		var_type type { var_type::_invalid };
 		std::string name;
 		OBJECT value;
 	};
@@ -37,8 +41,10 @@ struct context {
 		};
 		std::vector<arg_info> arguments;
 		var_type return_type;
+		int frame_size;
 
 		ast_node_base* block;
+		ast_node_function* function { nullptr };
 	};
 
 	static var_type cast_from_token(lexer::token_type type, bool is_array) {
@@ -72,14 +78,38 @@ struct context {
 		::abort();
 	}
 
+	size_t reserve_frame(int size) {
+		size_t bottom = frame_top;
+		frame_top += size;
+		if (frame_top > slots.size()) {
+			slots.resize(std::max(frame_top, slots.size() * 2));
+		}
+		return bottom;
+	}
+	size_t enter_frame(size_t bottom) {
+		size_t caller = frame_base;
+		frame_base = bottom;
+		return caller;
+	}
+	void leave_frame(size_t caller) {
+		frame_top = frame_base;
+		frame_base = caller;
+	}
+
 	std::optional<invalid_state> return_code;
 	bool is_abort { false };
-	std::map<std::string, var_info> var_table;
+	std::vector<var_info> globals;
+	std::map<std::string, int, std::less<>> global_slots;
+	std::vector<var_info> slots;
+	size_t frame_base { 0 };
+	size_t frame_top { 0 };
 	std::map<std::string, func_info> func_table;
 	std::list<std::string> name_space;
-	std::list<OBJECT> stack;
+	operand_stack stack;
 
 	std::vector<ast_node_base*> pre_evaluate;
+	ast_arena* arena { nullptr };
+	bool lazy_bodies { false };
 };
 
 struct cast_var_type_object {
@@ -111,6 +141,6 @@ struct cast_var_type_object {
 		return context::var_type::_invalid;
 	}
 	context::var_type operator()(auto) noexcept {
-		return invalid_state("failed to cast as var_type");
+		return context::var_type::_invalid;
 	}
 };
\ No newline at end of file
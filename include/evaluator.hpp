@@ -6,9 +6,6 @@ class ast_node_base;
 
 class ast_evaluator {
 public:
-	static std::string encode(const context& con, const std::string& name);
-	static std::map<std::string, context::var_info>::iterator find_var(context& con, const std::string name);
+	static context::var_info* find_var(context& con, int depth, int slot);
 	static std::map<std::string, context::func_info>::iterator find_func(context& con, const std::string name);
-public:
-	virtual std::optional<invalid_state> evaluate(context& con) { return con.return_code; }
 };
@@ -1,12 +1,17 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <array>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 
 
 struct code_point {
-	unsigned short line;
-	unsigned short col;
+	unsigned int line;
+	unsigned int col;
 };
 
 class lexer {
@@ -21,9 +26,17 @@ public:
 		arrow,
 		repeat,
 
-		comment_begin,
-		comment_end,
-		comment_line,
+		plus,
+		minus,
+		star,
+		slash,
+		assign,
+		equal,
+		not_equal,
+		less_than,
+		greater_than,
+		less_than_or_equal,
+		greater_than_or_equal,
 
 		identifier,
 
@@ -54,26 +67,154 @@ public:
 		eof,
 	};
 	struct token {
-		std::string raw;
+		uint32_t offset;
+		uint32_t length : 24;
+		token_type type : 8;
+	};
+	static_assert(sizeof(token) == 8);
+	inline static constexpr size_t max_token_length = (1 << 24) - 1;
+
+	struct lexeme {
+		std::string_view raw;
 		token_type type;
 		code_point point;
 	};
+
+	class source_map {
+	public:
+		explicit source_map(std::string_view text) :
+			text(text),
+			line_starts { 0 }
+		{}
+
+		std::string_view text_of(const token& tok) const {
+			return text.substr(tok.offset, tok.length);
+		}
+		code_point locate(uint32_t offset) const {
+			if (offset >= line_starts.back()) {
+				return code_point { .line = line_base + static_cast<unsigned int>(line_starts.size()), .col = offset - line_starts.back() };
+			}
+			std::vector<uint32_t>::const_iterator itr = std::upper_bound(line_starts.begin(), line_starts.end(), offset);
+			return code_point { .line = line_base + static_cast<unsigned int>(itr - line_starts.begin()), .col = offset - *(itr - 1) };
+		}
+		lexeme decode(const token& tok) const {
+			return lexeme { .raw = text_of(tok), .type = tok.type, .point = locate(tok.offset) };
+		}
+
+		std::string_view text;
+		std::vector<uint32_t> line_starts;
+		unsigned int line_base { 0 };
+	};
+
 private:
 	struct context {
-		code_point point;
-		std::string::const_iterator itr;
-		std::string::const_iterator end;
+		const char* begin;
+		const char* itr;
+		const char* end;
+		std::vector<uint32_t>* line_starts;
 	};
 	struct keyword_info {
-		std::string str;
+		std::string_view str;
 		lexer::token_type type;
 		bool is_keyword;
 	};
+	template <size_t Capacity>
+	struct keyword_trie {
+		struct node {
+			unsigned char next[128] {};
+			signed char accept { -1 };
+		};
+
+		template <size_t Count>
+		constexpr keyword_trie(const keyword_info (&keywords)[Count]) {
+			for (size_t i = 0; i < Count; ++i) {
+				size_t current = 0;
+				for (char c : keywords[i].str) {
+					unsigned char& next = nodes[current].next[static_cast<unsigned char>(c)];
+					if (!next) {
+						next = static_cast<unsigned char>(count++);
+					}
+					current = next;
+				}
+				nodes[current].accept = static_cast<signed char>(i);
+			}
+		}
+
+		node nodes[Capacity] {};
+		size_t count { 1 };
+	};
 public:
+	static const keyword_info* match_keyword(const char* itr, const char* end, size_t& length) noexcept;
 	static std::optional<token> try_parse_number(context& con) noexcept;
 	static std::optional<token> try_parse_sign_and_keyword(context& con) noexcept;
 	static std::optional<token> try_parse_identifier(context& con) noexcept;
 	static std::optional<token> try_parse_string(context& con) noexcept;
+	static const char* skip_block_comment(const char* itr, const char* end) noexcept;
+	static bool skip_comment(context& con) noexcept;
+	static bool skip_whitespace(context& con) noexcept;
+	static token make_token(const context& con, const char* start, const char* stop, token_type type) noexcept;
+	[[noreturn]] static void report_error(const context& con, const char* message) noexcept;
+	static token next(context& con) noexcept;
+
+	inline static constexpr size_t parallel_chunk = 256 * 1024;
+	static std::vector<const char*> split_source(std::string_view source, size_t parts) noexcept;
+	static void tokenize_range(context& con, std::vector<token>& toks) noexcept;
 public:
-	static std::vector<token> tokenize(const std::string& source) noexcept;
+	static std::vector<token> tokenize(source_map& map) noexcept;
+
+	class stream {
+	public:
+		inline static constexpr size_t lookahead = 4;
+
+		explicit stream(std::string_view source) :
+			map(source),
+			con { .begin = source.data(), .itr = source.data(), .end = source.data() + source.size(), .line_starts = &map.line_starts },
+			head(0),
+			count(0)
+		{}
+		stream(std::string_view source, const lexeme& start) :
+			stream(source)
+		{
+			uint32_t offset = static_cast<uint32_t>(start.raw.data() - source.data());
+			map.line_starts.front() = offset - start.point.col;
+			map.line_base = start.point.line - 1;
+			con.itr = source.data() + offset;
+		}
+
+		std::string_view source() const {
+			return map.text;
+		}
+
+		const lexeme& peek(size_t offset = 0) {
+			assert(offset < lookahead);
+			while (count <= offset) {
+				ring[(head + count++) % lookahead] = map.decode(lexer::next(con));
+			}
+			return ring[(head + offset) % lookahead];
+		}
+		const lexeme& operator*() {
+			return peek();
+		}
+		const lexeme* operator->() {
+			return &peek();
+		}
+		stream& operator++() {
+			peek();
+			head = (head + 1) % lookahead;
+			--count;
+			return *this;
+		}
+		lexeme operator++(int) {
+			lexeme current = peek();
+			++*this;
+			return current;
+		}
+
+	private:
+		source_map map;
+		context con;
+		std::array<lexeme, lookahead> ring {};
+		size_t head;
+		size_t count;
+	};
 };
\ No newline at end of file
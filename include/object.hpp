@@ -1,20 +1,226 @@
 #pragma once
-#include <variant>
+#include <type_traits>
 #include <string>
+#include <vector>
+#include <optional>
+#include <utility>
 #include "state.hpp"
 
 
-#define OBJECT std::variant<invalid_state, bool, int, float, std::string, std::vector<bool>, std::vector<int>, std::vector<float>, std::vector<std::string>>
-inline static constexpr size_t state_index = OBJECT(invalid_state()).index();
-inline static constexpr size_t bool_index = OBJECT(true).index();
-inline static constexpr size_t int_index = OBJECT(int(0)).index();
-inline static constexpr size_t float_index = OBJECT(float(0.f)).index();
-inline static constexpr size_t string_index = OBJECT(std::string()).index();
+inline static constexpr size_t state_index = 0;
+inline static constexpr size_t bool_index = 1;
+inline static constexpr size_t int_index = 2;
+inline static constexpr size_t float_index = 3;
+inline static constexpr size_t string_index = 4;
 
-inline static constexpr size_t bool_array_index = OBJECT(std::vector<bool>()).index();
-inline static constexpr size_t int_array_index = OBJECT(std::vector<int>()).index();
-inline static constexpr size_t float_array_index = OBJECT(std::vector<float>()).index();
-inline static constexpr size_t string_array_index = OBJECT(std::vector<std::string>()).index();
+inline static constexpr size_t bool_array_index = 5;
+inline static constexpr size_t int_array_index = 6;
+inline static constexpr size_t float_array_index = 7;
+inline static constexpr size_t string_array_index = 8;
+
+
+class object {
+private:
+	struct box_header {
+		size_t count;
+	};
+	template <class T>
+	struct boxed : box_header {
+		boxed(T value) : box_header { 1 }, value(std::move(value)) {}
+		T value;
+	};
+
+	template <class T>
+	static constexpr unsigned char index_of() noexcept {
+		if constexpr (std::is_same_v<T, invalid_state>) { return state_index; }
+		else if constexpr (std::is_same_v<T, bool>) { return bool_index; }
+		else if constexpr (std::is_same_v<T, int>) { return int_index; }
+		else if constexpr (std::is_same_v<T, float>) { return float_index; }
+		else if constexpr (std::is_same_v<T, std::string>) { return string_index; }
+		else if constexpr (std::is_same_v<T, std::vector<bool>>) { return bool_array_index; }
+		else if constexpr (std::is_same_v<T, std::vector<int>>) { return int_array_index; }
+		else if constexpr (std::is_same_v<T, std::vector<float>>) { return float_array_index; }
+		else { static_assert(std::is_same_v<T, std::vector<std::string>>); return string_array_index; }
+	}
+
+	template <class T>
+	void box(T&& value) {
+		data.ptr = new boxed<std::decay_t<T>>(std::forward<T>(value));
+	}
+
+	template <class T>
+	static void dispose(box_header* ptr) noexcept {
+		boxed<T>* item = static_cast<boxed<T>*>(ptr);
+		if (--item->count == 0) {
+			delete item;
+		}
+	}
+
+	template <class T>
+	static box_header* clone(box_header* ptr) {
+		boxed<T>* item = static_cast<boxed<T>*>(ptr);
+		--item->count;
+		return new boxed<T>(item->value);
+	}
+
+	bool is_boxed() const noexcept {
+		return tag == state_index ? data.ptr != nullptr : tag >= string_index;
+	}
+
+	void retain() const noexcept {
+		if (is_boxed()) {
+			++data.ptr->count;
+		}
+	}
+
+	void release() noexcept {
+		if (!is_boxed()) {
+			return;
+		}
+		switch (tag) {
+		case state_index: dispose<invalid_state>(data.ptr); break;
+		case string_index: dispose<std::string>(data.ptr); break;
+		case bool_array_index: dispose<std::vector<bool>>(data.ptr); break;
+		case int_array_index: dispose<std::vector<int>>(data.ptr); break;
+		case float_array_index: dispose<std::vector<float>>(data.ptr); break;
+		case string_array_index: dispose<std::vector<std::string>>(data.ptr); break;
+		}
+	}
+
+	static invalid_state& empty_state() noexcept {
+		static invalid_state state;
+		return state;
+	}
+
+	union {
+		bool b;
+		int i;
+		float f;
+		box_header* ptr;
+	} data;
+	unsigned char tag;
+
+public:
+	object() noexcept : tag(state_index) { data.ptr = nullptr; }
+	object(invalid_state value) : tag(state_index) {
+		if (value.message.empty()) {
+			data.ptr = nullptr;
+		} else {
+			box(std::move(value));
+		}
+	}
+	object(bool value) noexcept : tag(bool_index) { data.ptr = nullptr; data.b = value; }
+	object(std::vector<bool>::reference value) noexcept : object(static_cast<bool>(value)) {}
+	object(int value) noexcept : tag(int_index) { data.ptr = nullptr; data.i = value; }
+	object(float value) noexcept : tag(float_index) { data.ptr = nullptr; data.f = value; }
+	object(const char* value) : tag(string_index) { box(std::string(value)); }
+	object(std::string value) : tag(string_index) { box(std::move(value)); }
+	object(std::vector<bool> value) : tag(bool_array_index) { box(std::move(value)); }
+	object(std::vector<int> value) : tag(int_array_index) { box(std::move(value)); }
+	object(std::vector<float> value) : tag(float_array_index) { box(std::move(value)); }
+	object(std::vector<std::string> value) : tag(string_array_index) { box(std::move(value)); }
+
+	object(const object& other) noexcept : data(other.data), tag(other.tag) {
+		retain();
+	}
+	object(object&& other) noexcept : data(other.data), tag(other.tag) {
+		other.tag = state_index;
+		other.data.ptr = nullptr;
+	}
+	~object() {
+		release();
+	}
+
+	object& operator=(const object& other) noexcept {
+		other.retain();
+		release();
+		data = other.data;
+		tag = other.tag;
+		return *this;
+	}
+	object& operator=(object&& other) noexcept {
+		if (this != &other) {
+			release();
+			data = other.data;
+			tag = other.tag;
+			other.tag = state_index;
+			other.data.ptr = nullptr;
+		}
+		return *this;
+	}
+
+	size_t index() const noexcept {
+		return tag;
+	}
+
+	template <class T>
+	T& get() noexcept {
+		if constexpr (std::is_same_v<T, bool>) {
+			return data.b;
+		} else if constexpr (std::is_same_v<T, int>) {
+			return data.i;
+		} else if constexpr (std::is_same_v<T, float>) {
+			return data.f;
+		} else if constexpr (std::is_same_v<T, invalid_state>) {
+			return data.ptr ? static_cast<boxed<T>*>(data.ptr)->value : empty_state();
+		} else {
+			return static_cast<boxed<T>*>(data.ptr)->value;
+		}
+	}
+	template <class T>
+	const T& get() const noexcept {
+		return const_cast<object*>(this)->get<T>();
+	}
+
+	template <class T>
+	T* get_if() noexcept {
+		return tag == index_of<T>() ? &get<T>() : nullptr;
+	}
+	template <class T>
+	const T* get_if() const noexcept {
+		return tag == index_of<T>() ? &get<T>() : nullptr;
+	}
+
+	void detach() {
+		if (tag < string_index || data.ptr->count == 1) {
+			return;
+		}
+		switch (tag) {
+		case string_index: data.ptr = clone<std::string>(data.ptr); break;
+		case bool_array_index: data.ptr = clone<std::vector<bool>>(data.ptr); break;
+		case int_array_index: data.ptr = clone<std::vector<int>>(data.ptr); break;
+		case float_array_index: data.ptr = clone<std::vector<float>>(data.ptr); break;
+		case string_array_index: data.ptr = clone<std::vector<std::string>>(data.ptr); break;
+		}
+	}
+};
+static_assert(sizeof(object) == 16);
+
+#define OBJECT object
+
+template <class Visitor, class Object>
+decltype(auto) visit_object(Visitor&& visitor, Object&& value) {
+	switch (value.index()) {
+	case bool_index: return visitor(value.template get<bool>());
+	case int_index: return visitor(value.template get<int>());
+	case float_index: return visitor(value.template get<float>());
+	case string_index: return visitor(value.template get<std::string>());
+	case bool_array_index: return visitor(value.template get<std::vector<bool>>());
+	case int_array_index: return visitor(value.template get<std::vector<int>>());
+	case float_array_index: return visitor(value.template get<std::vector<float>>());
+	case string_array_index: return visitor(value.template get<std::vector<std::string>>());
+	default: return visitor(value.template get<invalid_state>());
+	}
+}
+
+template <class Visitor, class Lhs, class Rhs>
+decltype(auto) visit_object(Visitor&& visitor, Lhs&& lhs, Rhs&& rhs) {
+	return visit_object([&](auto& lhs_value) -> decltype(auto) {
+		return visit_object([&](auto& rhs_value) -> decltype(auto) {
+			return visitor(lhs_value, rhs_value);
+		}, rhs);
+	}, lhs);
+}
 
 inline static std::string type_names[] = {
 	"invalid_state", "bool", "int", "float", "string",
@@ -0,0 +1,99 @@
+#pragma once
+#include <memory>
+#include <iostream>
+#include <cstdlib>
+#include "object.hpp"
+
+
+class operand_stack {
+public:
+	inline static constexpr size_t default_depth = 1 << 16;
+	inline static constexpr size_t call_headroom = 256;
+
+	operand_stack(size_t depth = default_depth) :
+		data(std::make_unique<OBJECT[]>(depth)),
+		top(0),
+		depth(depth),
+		peak_depth(0)
+	{}
+
+	void set_capacity(size_t new_depth) {
+		if (new_depth < top || new_depth == depth) {
+			return;
+		}
+		std::unique_ptr<OBJECT[]> buffer = std::make_unique<OBJECT[]>(new_depth);
+		for (size_t i = 0; i < top; ++i) {
+			buffer[i] = std::move(data[i]);
+		}
+		data = std::move(buffer);
+		depth = new_depth;
+	}
+
+	void push_back(OBJECT value) {
+#ifndef NDEBUG
+		if (top >= depth) {
+			overflow();
+		}
+#endif
+		data[top++] = std::move(value);
+		if (top > peak_depth) {
+			peak_depth = top;
+		}
+	}
+	void pop_back() {
+#ifndef NDEBUG
+		if (!top) {
+			underflow();
+		}
+#endif
+		--top;
+	}
+	OBJECT& back() {
+#ifndef NDEBUG
+		if (!top) {
+			underflow();
+		}
+#endif
+		return data[top - 1];
+	}
+	OBJECT& operator[](size_t index) {
+		return data[index];
+	}
+	void resize(size_t size) {
+		if (size < top) {
+			top = size;
+		}
+	}
+
+	bool has_headroom() const {
+		return top + call_headroom <= depth;
+	}
+
+	size_t size() const {
+		return top;
+	}
+	bool empty() const {
+		return !top;
+	}
+	size_t capacity() const {
+		return depth;
+	}
+	size_t peak() const {
+		return peak_depth;
+	}
+
+private:
+	[[noreturn]] void overflow() const {
+		std::cout << "runtime error: operand stack overflow (depth: " << depth << ")" << std::endl;
+		::abort();
+	}
+	[[noreturn]] void underflow() const {
+		std::cout << "runtime error: operand stack underflow" << std::endl;
+		::abort();
+	}
+
+	std::unique_ptr<OBJECT[]> data;
+	size_t top;
+	size_t depth;
+	size_t peak_depth;
+};
@@ -1,99 +1,137 @@
 #pragma once
 
 #include <memory>
+#include <array>
+#include <atomic>
 #include "lexer.hpp"
 #include "evaluator.hpp"
-
+#include "ast_arena.hpp"
+
+
+enum class node_kind : uint8_t {
+	base,
+	error,
+	string,
+	value,
+	call_function,
+	bin,
+	expr,
+	_return,
+	block,
+	function,
+	repeat,
+	array_reference,
+	var_definition,
+	_if,
+	_while,
+	do_while,
+	initial_list,
+	_class,
+	program,
+};
 
 template <class Type, class UType>
 bool is_a(UType target) {
-	return target->get_tag() == &Type::tag;
+	return target->kind == Type::tag;
 }
 
 class ast_node_base : public ast_evaluator {
 public:
-	struct ast_base_tag {};
-	inline static constexpr ast_base_tag tag;
+	inline static constexpr node_kind tag = node_kind::base;
+	using evaluator = std::optional<invalid_state> (*)(ast_node_base* node, context& con);
+	static const std::array<evaluator, static_cast<size_t>(node_kind::program) + 1> evaluators;
 public:
-	ast_node_base() = default;
+	explicit ast_node_base(node_kind kind = tag) :
+		kind(kind)
+	{}
 	virtual ~ast_node_base() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_base::tag; }
-
-	virtual std::string log(std::string indent) {
-		return "";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con) { return con.return_code; }
+	std::optional<invalid_state> evaluate(context& con);
 
+	node_kind kind;
+	bool typed { false };
 	code_point point { 0, 0 };
 };
 
 class ast_node_error : public ast_node_base {
 public:
-	struct ast_error_tag : public ast_base_tag {};
-	inline static constexpr ast_error_tag tag;
+	inline static constexpr node_kind tag = node_kind::error;
 public:
 	ast_node_error(const std::string& text, code_point point) :
+		ast_node_base(tag),
 		text(text)
 	{
 		this->point = point;
 	}
 	virtual ~ast_node_error() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_error::tag; }
-	virtual std::string log(std::string indent) {
-		return indent + "<error code_point=(" + std::to_string(point.line) + "," + std::to_string(point.col) + ")>" + text + "</error>\n";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
+	std::optional<invalid_state> evaluate(context& con);
 	std::string text;
 };
 
 class ast_node_string : public ast_node_base {
 public:
-	struct ast_string_tag : public ast_base_tag {};
-	inline static constexpr ast_string_tag tag;
+	inline static constexpr node_kind tag = node_kind::string;
 public:
-	ast_node_string(const lexer::token& value, code_point point) :
-		value(value)
+	ast_node_string(const lexer::lexeme& value, code_point point) :
+		ast_node_base(tag),
+		value(value),
+		constant(std::string(value.raw))
 	{
 		this->point = point;
 	}
 	virtual ~ast_node_string() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_string::tag; }
-	virtual std::string log(std::string indent) {
-		return indent + "<value>" + value.raw + "</value>\n";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
-	lexer::token value;
+	std::optional<invalid_state> evaluate(context& con);
+	lexer::lexeme value;
+	OBJECT constant;
 };
 
 class ast_node_value : public ast_node_base {
 public:
-	struct ast_value_tag : public ast_base_tag {};
-	inline static constexpr ast_value_tag tag;
+	inline static constexpr node_kind tag = node_kind::value;
 public:
-	ast_node_value(const lexer::token& value, code_point point) :
-		value(value)
+	ast_node_value(const lexer::lexeme& value, code_point point) :
+		ast_node_base(tag),
+		value(value),
+		constant(decode(value))
 	{
 		this->point = point;
 	}
 	virtual ~ast_node_value() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_value::tag; }
-	virtual std::string log(std::string indent) {
-		return indent + "<value>" + value.raw + "</value>\n";
+	std::optional<invalid_state> evaluate(context& con);
+
+	static OBJECT decode(const lexer::lexeme& value) {
+		switch (value.type) {
+		case lexer::token_type::identifier:
+			return invalid_state();
+		case lexer::token_type::_true:
+			return true;
+		case lexer::token_type::_false:
+			return false;
+		default:
+			break;
+		}
+		std::string digits(value.raw);
+		if (digits.find('.') != std::string::npos) {
+			return static_cast<float>(std::stod(digits));
+		}
+		return std::atoi(digits.c_str());
 	}
-	virtual std::optional<invalid_state> evaluate(context& con);
-	lexer::token value;
+
+	lexer::lexeme value;
+	OBJECT constant;
+	int depth { -1 };
+	int slot { -1 };
 };
 
 class ast_node_call_function : public ast_node_base {
 public:
-	struct ast_call_function_tag : public ast_base_tag {};
-	inline static constexpr ast_call_function_tag tag;
+	inline static constexpr node_kind tag = node_kind::call_function;
 public:
-	ast_node_call_function(const std::string& function_name, std::vector<std::unique_ptr<ast_node_base>>&& arguments, code_point point) :
+	ast_node_call_function(const std::string& function_name, std::vector<ast_node_base*>&& arguments, code_point point) :
+		ast_node_base(tag),
 		function_name(function_name),
 		arguments(std::move(arguments))
 	{
@@ -101,125 +139,113 @@ public:
 	}
 	virtual ~ast_node_call_function() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_call_function::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<call_function name=\"" + function_name + "\">\n";
-		ret += indent + "\t<arguments>\n";
-		for (const std::unique_ptr<ast_node_base>& arg : arguments) {
-			ret += arg->log(indent + "\t\t");
-		}
-		ret += indent + "\t</arguments>\n";
-		ret += indent + "</call_function>\n";
-		return ret;
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
+	std::optional<invalid_state> evaluate(context& con);
 	std::string function_name;
-	std::vector<std::unique_ptr<ast_node_base>> arguments;
+	std::vector<ast_node_base*> arguments;
 };
 
 class ast_node_bin : public ast_node_base {
 public:
-	struct ast_bin_tag : public ast_base_tag {};
-	inline static constexpr ast_bin_tag tag;
-public:
-	ast_node_bin() = default;
-	ast_node_bin(const std::string& op, std::unique_ptr<ast_node_base>&& lhs, std::unique_ptr<ast_node_base>&& rhs, code_point point) :
+	inline static constexpr node_kind tag = node_kind::bin;
+
+	enum class op_type : unsigned char {
+		unknown,
+		assign,
+		add,
+		sub,
+		mul,
+		div,
+		equal,
+		not_equal,
+		less_than,
+		greater_than,
+		less_than_or_equal,
+		greater_than_or_equal,
+	};
+
+	static const char* sign_of(op_type op) {
+		static const char* signs[] = { "?", "=", "+", "-", "*", "/", "==", "!=", "<", ">", "<=", ">=" };
+		return signs[static_cast<int>(op)];
+	}
+public:
+	ast_node_bin() :
+		ast_node_base(tag)
+	{}
+	ast_node_bin(op_type op, ast_node_base* lhs, ast_node_base* rhs, code_point point) :
+		ast_node_base(tag),
 		op(op),
-		lhs(std::move(lhs)),
-		rhs(std::move(rhs))
+		lhs(lhs),
+		rhs(rhs)
 	{
 		this->point = point;
 	}
 	virtual ~ast_node_bin() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_bin::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<bin op=\"" + op + "\">\n";
-		if (lhs) {
-			ret += lhs->log(indent + '\t');
-		} else {
-			ret += indent + "\t<value>error</value>\n";
-		}
-		if (rhs) {
-			ret += rhs->log(indent + '\t');
-		} else {
-			ret += indent + "\t<value>error</value>\n";
-		}
-		return ret + indent + "</bin>\n";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
-	std::string op;
-	std::unique_ptr<ast_node_base> lhs;
-	std::unique_ptr<ast_node_base> rhs;
+	std::optional<invalid_state> evaluate(context& con);
+	static OBJECT operate(op_type op, OBJECT& lhs, OBJECT& rhs);
+	op_type op { op_type::unknown };
+	ast_node_base* lhs { nullptr };
+	ast_node_base* rhs { nullptr };
+	context::var_type operand_type { context::var_type::_invalid };
 };
 
 class ast_node_expr : public ast_node_base {
 public:
-	struct ast_expr_tag : public ast_base_tag {};
-	inline static constexpr ast_expr_tag tag;
+	inline static constexpr node_kind tag = node_kind::expr;
 public:
-	ast_node_expr(std::unique_ptr<ast_node_base>&& expr, code_point point) :
-		expr(std::move(expr))
+	ast_node_expr(ast_node_base* expr, code_point point) :
+		ast_node_base(tag),
+		expr(expr)
 	{
 		this->point = point;
 	}
 	virtual ~ast_node_expr() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_expr::tag; }
-	virtual std::string log(std::string indent) {
-		if (expr) {
-			return expr->log(indent);
-		}
-		return indent + "<expr>error</expr>\n";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
-	std::unique_ptr<ast_node_base> expr;
+	std::optional<invalid_state> evaluate(context& con);
+	ast_node_base* expr { nullptr };
 };
 
 class ast_node_return : public ast_node_base {
 public:
-	struct ast_return_tag : public ast_base_tag {};
-	inline static constexpr ast_return_tag tag;
+	inline static constexpr node_kind tag = node_kind::_return;
 public:
-	ast_node_return(std::unique_ptr<ast_node_base>&& value, code_point point) :
-		value(std::move(value))
+	ast_node_return(ast_node_base* value, code_point point) :
+		ast_node_base(tag),
+		value(value)
 	{
 		this->point = point;
 	}
 	virtual ~ast_node_return() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_return::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<return>\n";
-		if (value) {
-			ret += value->log(indent + '\t');
-		} else {
-			ret += indent + "\t<error>no expression</error>\n";
-		}
-		return ret + indent + "</return>\n";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
-	std::unique_ptr<ast_node_base> value;
+	std::optional<invalid_state> evaluate(context& con);
+	ast_node_base* value { nullptr };
 };
 
 class ast_node_block : public ast_node_base {
 public:
-	struct ast_return_tag : public ast_base_tag {};
-	inline static constexpr ast_return_tag tag;
+	inline static constexpr node_kind tag = node_kind::block;
 
 public:
+	inline static std::atomic<int> block_counter { 0 };
+	inline static thread_local std::vector<std::string*>* deferred_names { nullptr };
+	inline static constexpr char deferred_mark = '#';
+
 	static std::string generate_blockname() {
-		static int i = 0;
-		return "block_" + std::to_string(i++);
+		return "block_" + std::to_string(block_counter++);
 	}
 public:
-	ast_node_block(std::vector<std::unique_ptr<ast_node_base>>&& exprs, code_point point) :
+	ast_node_block(std::vector<ast_node_base*>&& exprs, code_point point) :
+		ast_node_base(tag),
 		exprs(std::move(exprs)),
-		block_name(generate_blockname())
+		block_name(deferred_names ? std::string(1, deferred_mark) : generate_blockname())
 	{
 		this->point = point;
+		if (deferred_names) {
+			deferred_names->push_back(&block_name);
+		}
 	}
-	ast_node_block(std::vector<std::unique_ptr<ast_node_base>>&& exprs, const std::string& block_name, code_point point) :
+	ast_node_block(std::vector<ast_node_base*>&& exprs, const std::string& block_name, code_point point) :
+		ast_node_base(tag),
 		exprs(std::move(exprs)),
 		block_name(block_name)
 	{
@@ -227,157 +253,94 @@ public:
 	}
 	virtual ~ast_node_block() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_block::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<" + block_name + ">\n";
-		for (const std::unique_ptr<ast_node_base>& item : exprs) {
-			ret += item->log(indent + '\t');
-		}
-		return ret + indent + "</" + block_name + ">\n";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
-	std::vector<std::unique_ptr<ast_node_base>> exprs;
+	std::optional<invalid_state> evaluate(context& con);
+	std::vector<ast_node_base*> exprs;
 	std::string block_name;
+	ast_node_function* owner { nullptr };
 };
 
 class ast_node_function : public ast_node_base {
 public:
-	struct ast_function_tag : public ast_base_tag {};
-	inline static constexpr ast_function_tag tag;
+	inline static constexpr node_kind tag = node_kind::function;
 
 public:
 	ast_node_function() :
+		ast_node_base(tag),
 		block(nullptr),
 		function_name(),
 		arguments({}),
 		return_type(context::var_type::_invalid),
-		return_type_size(-1)
+		return_type_size(-1),
+		frame_size(0)
 	{}
 	virtual ~ast_node_function() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_function::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<function name=" + function_name + ">\n";
-		ret += indent + "\t<return type=\"";
-		switch (return_type) {
-		case context::var_type::_invalid: ret += "invalid"; break;
-		case context::var_type::_int: ret += "int"; break;
-		case context::var_type::_float: ret += "float"; break;
-		case context::var_type::_bool: ret += "bool"; break;
-		case context::var_type::_str: ret += "str"; break;
-		case context::var_type::_int_array: ret += "int[]"; break;
-		case context::var_type::_float_array: ret += "float[]"; break;
-		case context::var_type::_bool_array: ret += "bool[]"; break;
-		case context::var_type::_str_array: ret += "str[]"; break;
-		}
-		ret += "\"></return>\n";
-		for (const context::var_info& arg : arguments) {
-			ret += indent + "\t<argument type=\"";
-			switch (arg.modifier) {
-			case lexer::token_type::_mut: ret += "mut"; break;
-			case lexer::token_type::_const: ret += "const"; break;
-			}
-			switch (arg.type) {
-			case context::var_type::_int: ret += " int"; break;
-			case context::var_type::_float: ret += " float"; break;
-			case context::var_type::_bool: ret += " bool"; break;
-			case context::var_type::_str: ret += " str"; break;
-			case context::var_type::_int_array: ret += " int[]"; break;
-			case context::var_type::_float_array: ret += " float[]"; break;
-			case context::var_type::_bool_array: ret += " bool[]"; break;
-			case context::var_type::_str_array: ret += " str[]"; break;
-			}
-			ret += "\">" + arg.name + "</argument>\n";
-		}
-		if (block) {
-			if (ast_node_block* casted_block = dynamic_cast<ast_node_block*>(block.get())) {
-				casted_block->block_name = "implement";
-				ret += block->log(indent + "\t");
-				casted_block->block_name = function_name;
-			}
-		}
-		ret += indent + "</function>\n";
-		return ret;
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
-	std::unique_ptr<ast_node_base> block;
+	std::optional<invalid_state> evaluate(context& con);
+	struct lazy_body {
+		std::string_view source;
+		lexer::lexeme open;
+		lexer::lexeme name;
+		ast_arena* arena;
+	};
+	ast_node_base* block { nullptr };
+	std::optional<lazy_body> lazy;
 	std::string function_name;
 
 	std::vector<context::var_info> arguments;
 
 	context::var_type return_type;
 	int return_type_size;
+	int frame_size;
 };
 
 class ast_node_repeat : public ast_node_base {
 public:
-	struct ast_repeat_tag : public ast_base_tag {};
-	inline static constexpr ast_repeat_tag tag;
+	inline static constexpr node_kind tag = node_kind::repeat;
 public:
-	ast_node_repeat(std::unique_ptr<ast_node_base>&& bgn, std::unique_ptr<ast_node_base>&& end, code_point point) :
-		bgn(std::move(bgn)),
-		end(std::move(end))
+	ast_node_repeat(ast_node_base* bgn, ast_node_base* end, code_point point) :
+		ast_node_base(tag),
+		bgn(bgn),
+		end(end)
 	{
 		this->point = point;
 	}
 
 	virtual ~ast_node_repeat() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_repeat::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<repeat>\n";
-		if (bgn) {
-			ret += bgn->log(indent + "\t");
-		}
-		if (end) {
-			ret += end->log(indent + "\t");
-		}
-		return ret + indent + "<repeat>\n";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
+	std::optional<invalid_state> evaluate(context& con);
 
-	std::unique_ptr<ast_node_base> bgn;
-	std::unique_ptr<ast_node_base> end;
+	ast_node_base* bgn { nullptr };
+	ast_node_base* end { nullptr };
 };
 
 class ast_node_array_refernce : public ast_node_base {
 public:
-	struct ast_array_reference_tag : public ast_base_tag {};
-	inline static constexpr ast_array_reference_tag tag;
+	inline static constexpr node_kind tag = node_kind::array_reference;
 public:
-	ast_node_array_refernce(const lexer::token& name, std::unique_ptr<ast_node_base>&& index, code_point point) :
+	ast_node_array_refernce(const lexer::lexeme& name, ast_node_base* index, code_point point) :
+		ast_node_base(tag),
 		name(name),
-		index(std::move(index))
+		index(index)
 	{
 		this->point = point;
 	}
 
 	virtual ~ast_node_array_refernce() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_array_refernce::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<array-reference>\n";
-		ret += indent + "\t<variable>" + name.raw + "</variable>\n";
-		ret += indent + "\t<index>\n";
-		if (index) {
-			ret += index->log(indent + "\t\t");
-		}
-		ret += indent + "\t</index>\n";
-		ret += indent + "</array-reference>\n";
-		return ret;
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
+	std::optional<invalid_state> evaluate(context& con);
 
-	lexer::token name;
-	std::unique_ptr<ast_node_base> index;
+	lexer::lexeme name;
+	ast_node_base* index { nullptr };
+	int depth { -1 };
+	int slot { -1 };
 };
 
 class ast_node_var_definition : public ast_node_base {
 public:
-	struct ast_var_definition_tag : public ast_base_tag {};
-	inline static constexpr ast_var_definition_tag tag;
+	inline static constexpr node_kind tag = node_kind::var_definition;
 public:
 	ast_node_var_definition(lexer::token_type modifier, std::string name, context::var_type type, int size, code_point point) :
+		ast_node_base(tag),
 		modifier(modifier),
 		name(name),
 		type(type),
@@ -385,267 +348,208 @@ public:
 	{
 		this->point = point;
 	}
-	ast_node_var_definition(lexer::token_type modifier, std::string name, context::var_type type, int size, std::unique_ptr<ast_node_base>&& init_value, code_point point) :
+	ast_node_var_definition(lexer::token_type modifier, std::string name, context::var_type type, int size, ast_node_base* init_value, code_point point) :
+		ast_node_base(tag),
 		modifier(modifier),
 		name(name),
 		type(type),
-		init_value(std::move(init_value)),
+		init_value(init_value),
 		size(size)
 	{
 		this->point = point;
 	}
 	virtual ~ast_node_var_definition() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_var_definition::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = "";
-		ret += indent + "<define type=\"";
-		switch (modifier) {
-		case lexer::token_type::_mut: ret += "mut"; break;
-		case lexer::token_type::_const: ret += "const"; break;
-		}
-		switch (type) {
-		case context::var_type::_int: ret += " int"; break;
-		case context::var_type::_float: ret += " float"; break;
-		}
-		if (size > 0) {
-			ret += "[" + std::to_string(size)  + "]";
-		} else if (!size) {
-			ret += "[]";
-		}
-		ret += "\">\n";
-		ret += indent + "\t<name>" + name + "</name>\n";
-		if (init_value) {
-			ret += indent + "\t<init>\n";
-			ret += init_value->log(indent + "\t\t");
-			ret += indent + "\t</init>\n";
-		}
-		ret += indent + "</define>\n";
-		return ret;
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
+	std::optional<invalid_state> evaluate(context& con);
 	lexer::token_type modifier;
 	std::string name;
 	context::var_type type;
-	std::unique_ptr<ast_node_base> init_value;
+	ast_node_base* init_value { nullptr };
 	int size;
+	int depth { -1 };
+	int slot { -1 };
 };
 
 class ast_node_if : public ast_node_base {
 public:
-	struct ast_if_tag : public ast_base_tag {};
-	inline static constexpr ast_if_tag tag;
+	inline static constexpr node_kind tag = node_kind::_if;
 public:
-	ast_node_if(std::unique_ptr<ast_node_base>&& condition_block, std::unique_ptr<ast_node_base>&& true_block) :
-		condition_block(std::move(condition_block)),
-		true_block(std::move(true_block)),
+	ast_node_if(ast_node_base* condition_block, ast_node_base* true_block) :
+		ast_node_base(tag),
+		condition_block(condition_block),
+		true_block(true_block),
 		false_block(nullptr)
 	{}
-	ast_node_if(std::unique_ptr<ast_node_base>&& condition_block, std::unique_ptr<ast_node_base>&& true_block, std::unique_ptr<ast_node_base>&& false_block) :
-		condition_block(std::move(condition_block)),
-		true_block(std::move(true_block)),
-		false_block(std::move(false_block))
+	ast_node_if(ast_node_base* condition_block, ast_node_base* true_block, ast_node_base* false_block) :
+		ast_node_base(tag),
+		condition_block(condition_block),
+		true_block(true_block),
+		false_block(false_block)
 	{}
 	~ast_node_if() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_if::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = "";
-		ret += indent + "<if>\n";
-		ret += indent + "\t<condition>\n";
-		ret += condition_block->log(indent + "\t\t");
-		ret += indent + "\t</condition>\n";
-		if (true_block) {
-			ret += true_block->log(indent + "\t");
-		}
-		else {
-			ret += indent + "\t<expr>error</expr>\n";
-		}
-		if (false_block) {
-			ret += false_block->log(indent + "\t");
-		}
-		ret += indent + "</if>\n";
-		return ret;
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
+	std::optional<invalid_state> evaluate(context& con);
 
-	std::unique_ptr<ast_node_base> condition_block;
-	std::unique_ptr<ast_node_base> true_block;
-	std::unique_ptr<ast_node_base> false_block;
+	ast_node_base* condition_block { nullptr };
+	ast_node_base* true_block { nullptr };
+	ast_node_base* false_block { nullptr };
 };
 
 class ast_node_while : public ast_node_base {
 public:
-	struct ast_while_tag : public ast_base_tag {};
-	inline static constexpr ast_while_tag tag;
+	inline static constexpr node_kind tag = node_kind::_while;
 public:
-	ast_node_while(std::unique_ptr<ast_node_base>&& condition, std::unique_ptr<ast_node_base>&& block, code_point point) :
-		condition(std::move(condition)),
-		block(std::move(block))
+	ast_node_while(ast_node_base* condition, ast_node_base* block, code_point point) :
+		ast_node_base(tag),
+		condition(condition),
+		block(block)
 	{
 		this->point = point;
 	}
 	~ast_node_while() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_while::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<while>\n";
-		ret += indent + "\t<condition>\n";
-		ret += condition->log(indent + "\t");
-		ret += indent + "\t</condition>\n";
-		ret += block->log(indent + "\t");
-		ret += indent + "</while>\n";
-		return ret;
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
+	std::optional<invalid_state> evaluate(context& con);
 
-	std::unique_ptr<ast_node_base> condition;
-	std::unique_ptr<ast_node_base> block;
+	ast_node_base* condition { nullptr };
+	ast_node_base* block { nullptr };
 };
 
 class ast_node_do_while : public ast_node_base {
 public:
-	struct ast_do_while_tag : public ast_base_tag {};
-	inline static constexpr ast_do_while_tag tag;
+	inline static constexpr node_kind tag = node_kind::do_while;
 public:
-	ast_node_do_while(std::unique_ptr<ast_node_base>&& condition, std::unique_ptr<ast_node_base>&& block, code_point point) :
-		condition(std::move(condition)),
-		block(std::move(block))
+	ast_node_do_while(ast_node_base* condition, ast_node_base* block, code_point point) :
+		ast_node_base(tag),
+		condition(condition),
+		block(block)
 	{
 		this->point = point;
 	}
 	~ast_node_do_while() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_do_while::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<do-while>\n";
-		ret += indent + "\t<condition>\n";
-		ret += condition->log(indent + "\t");
-		ret += indent + "\t</condition>\n";
-		ret += block->log(indent + "\t");
-		ret += indent + "</do-while>\n";
-		return ret;
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
+	std::optional<invalid_state> evaluate(context& con);
 
-	std::unique_ptr<ast_node_base> condition;
-	std::unique_ptr<ast_node_base> block;
+	ast_node_base* condition { nullptr };
+	ast_node_base* block { nullptr };
 };
 
 class ast_node_initial_list : public ast_node_base {
 public:
-	struct ast_initial_list_tag : public ast_base_tag {};
-	inline static constexpr ast_initial_list_tag tag;
+	inline static constexpr node_kind tag = node_kind::initial_list;
 public:
-	ast_node_initial_list(std::vector<std::unique_ptr<ast_node_base>>&& values, code_point point) :
+	ast_node_initial_list(std::vector<ast_node_base*>&& values, code_point point) :
+		ast_node_base(tag),
 		values(std::move(values))
 	{
 		this->point = point;
 	}
 	virtual ~ast_node_initial_list() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_initial_list::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<initialize>\n";
+	std::optional<invalid_state> evaluate(context& con);
 
-		for (const std::unique_ptr<ast_node_base>& value : values) {
-			ret += indent + "\t<value>\n";
-			ret += value->log(indent + "\t\t");
-			ret += indent + "\t</value>\n";
-		}
-		return ret + indent + "</initialize>\n";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
-
-	std::vector<std::unique_ptr<ast_node_base>> values;
+	std::vector<ast_node_base*> values;
 };
 
 class ast_node_class : public ast_node_base {
 public:
-	struct ast_class_tag : public ast_base_tag {};
-	inline static constexpr ast_class_tag tag;
+	inline static constexpr node_kind tag = node_kind::_class;
 public:
-	ast_node_class(const lexer::token& name, std::unique_ptr<ast_node_base>&& block, code_point point) :
+	ast_node_class(const lexer::lexeme& name, ast_node_base* block, code_point point) :
+		ast_node_base(tag),
 		name(name),
-		block(std::move(block))
+		block(block)
 	{
 		this->point = point;
 	}
 	~ast_node_class() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_class::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = indent + "<class name=\"" + name.raw + "\">\n";
-		if (block) {
-			ret += block->log(indent + "\t");
-		}
-		return ret + indent + "</class>\n";
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
+	std::optional<invalid_state> evaluate(context& con);
 
-	lexer::token name;
-	std::unique_ptr<ast_node_base> block;
+	lexer::lexeme name;
+	ast_node_base* block { nullptr };
 };
 
 class ast_node_program : public ast_node_base {
 public:
-	struct ast_expr_tag : public ast_base_tag {};
-	inline static constexpr ast_expr_tag tag;
+	inline static constexpr node_kind tag = node_kind::program;
 public:
-	ast_node_program(std::vector<std::unique_ptr<ast_node_base>>&& exprs, code_point point) :
+	ast_node_program(std::vector<ast_node_base*>&& exprs, code_point point) :
+		ast_node_base(tag),
 		exprs(std::move(exprs))
 	{
 		this->point = point;
 	}
 	~ast_node_program() = default;
 
-	virtual const ast_base_tag* get_tag() const { return &ast_node_expr::tag; }
-	virtual std::string log(std::string indent) {
-		std::string ret = "";
-		ret += indent + "<program>\n";
-		if (exprs.size()) {
-			for (const std::unique_ptr<ast_node_base>& item : exprs) {
-				ret += item->log(indent + "\t");
-			}
-		} else {
-			ret += indent + "\t<expr>error</expr>\n";
-		}
-		ret += indent + "</program>\n";
-		return ret;
-	}
-	virtual std::optional<invalid_state> evaluate(context& con);
-	std::vector<std::unique_ptr<ast_node_base>> exprs;
+	std::optional<invalid_state> evaluate(context& con);
+	std::vector<ast_node_base*> exprs;
+};
+
+inline std::optional<invalid_state> ast_node_base::evaluate(context& con) {
+	return evaluators[static_cast<uint8_t>(kind)](this, con);
+}
+
+struct ast_tree {
+	std::unique_ptr<ast_arena> arena;
+	ast_node_base* root { nullptr };
 };
 
 class parser {
 private:
-	static void skip_until_semicolon(std::vector<lexer::token>::const_iterator& itr);
-public:
-	static std::unique_ptr<ast_node_base> try_class_block(context& con, const std::string& name, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_class_member_function(context& con, const std::string& name, std::vector<lexer::token>::const_iterator& itr);
-
-	static std::unique_ptr<ast_node_base> try_build_class(context& con, std::vector<lexer::token>::const_iterator& itr);
-public:
-	static std::unique_ptr<ast_node_base> try_build_value(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_repeat(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_call_function(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_reference_array(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_timedivide_node(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_plusminus_node(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_equality(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_relational(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_expr(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_return(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_var_definition(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_initial_list(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_assign(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_if(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_while(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_do_while(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_block(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_function(context& con, std::vector<lexer::token>::const_iterator& itr);
-	static bool try_skip_comment(std::vector<lexer::token>::const_iterator& itr);
-	static std::unique_ptr<ast_node_base> try_build_program(context& con, std::vector<lexer::token>::const_iterator& itr);
-public:
-	static std::unique_ptr<ast_node_base> parse(context& con, const std::vector<lexer::token>& toks) noexcept;
+	struct binary_info {
+		ast_node_bin::op_type op { ast_node_bin::op_type::unknown };
+		int precedence { 0 };
+		bool right_associative { false };
+		bool chainable { true };
+		bool requires_rhs { false };
+	};
+	static const std::array<binary_info, 256> binary_table;
+	inline static constexpr int max_precedence = 5;
+
+	static void skip_until_semicolon(lexer::stream& itr);
+	static void skip_block(lexer::stream& itr);
+
+	inline static constexpr size_t parallel_source = 64 * 1024;
+	inline static constexpr size_t parallel_definitions = 64;
+	struct definition {
+		lexer::lexeme start;
+		uint32_t end;
+		bool is_class;
+	};
+	struct batch {
+		size_t first;
+		size_t last;
+		std::vector<ast_node_base*> nodes;
+		std::vector<ast_node_base*> functions;
+		std::vector<std::string*> names;
+		bool complete;
+	};
+	static std::vector<definition> split_definitions(const lexer::source_map& lines, const std::vector<lexer::token>& toks);
+	static void parse_batches(std::string_view source, const std::vector<definition>& definitions, std::vector<batch>& batches, std::atomic<size_t>& next, ast_arena& arena, bool lazy_bodies);
+	static ast_node_base* try_build_program_parallel(context& con, std::string_view source, ast_arena& arena);
+public:
+	static ast_node_base* try_class_block(context& con, std::string_view name, lexer::stream& itr);
+	static ast_node_base* try_class_member_function(context& con, std::string_view name, lexer::stream& itr);
+
+	static ast_node_base* try_build_class(context& con, lexer::stream& itr);
+public:
+	static ast_node_base* try_build_value(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_repeat(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_call_function(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_reference_array(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_binary(context& con, lexer::stream& itr, int min_precedence = 1);
+	static ast_node_base* try_build_expr(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_return(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_var_definition(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_initial_list(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_if(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_while(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_do_while(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_block(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_function(context& con, lexer::stream& itr);
+	static ast_node_base* try_build_program(context& con, lexer::stream& itr);
+public:
+	static ast_tree parse(context& con, std::string_view source) noexcept;
+	static ast_node_base* parse_body(context& con, context::func_info& info);
+	static void parse_all_bodies(context& con);
 };
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+#include "parser.hpp"
+#include "context.hpp"
+
+
+class resolver {
+private:
+	struct state {
+		std::vector<std::map<std::string, int, std::less<>>> global_scopes;
+		std::vector<std::map<std::string, int, std::less<>>> local_scopes;
+		int global_count;
+		int local_count;
+	};
+	static bool lookup(state& st, std::string_view name, int& depth, int& slot);
+	static bool declare(state& st, std::string_view name, int& depth, int& slot);
+
+	static void resolve_node(state& st, ast_node_base* node);
+	static void resolve_block(state& st, ast_node_block* node);
+	static void resolve_function(state& st, ast_node_function* node);
+public:
+	static void resolve(context& con, ast_node_base* root);
+	static void resolve(context& con, ast_node_function* node);
+};
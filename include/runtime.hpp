@@ -5,7 +5,14 @@
 
 class runtime {
 public:
-	static OBJECT evaluate(const std::unique_ptr<ast_node_base>& node, context& con);
-	static OBJECT evaluate(const std::unique_ptr<ast_node_base>& node);
+	enum class engine {
+		tree_walk,
+		bytecode_vm,
+	};
+public:
+	static OBJECT evaluate(ast_node_base* node, context& con);
+	static OBJECT evaluate(ast_node_base* node, context& con, engine kind);
+	static OBJECT evaluate(ast_node_base* node);
+	static OBJECT evaluate_function(ast_node_base* node, context& con, const std::string& name, engine kind);
 	static void evaluate_pre_process(context& node);
-};
\ No newline at end of file
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+class source_buffer {
+private:
+	inline static constexpr size_t read_chunk = 64 * 1024;
+
+#ifndef _WIN32
+	bool map(int fd, size_t size) {
+		void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED) {
+			return false;
+		}
+		::madvise(addr, size, MADV_SEQUENTIAL);
+		mapping = addr;
+		mapping_size = size;
+		return true;
+	}
+
+	bool read_all(int fd) {
+		size_t used = 0;
+		for (;;) {
+			fallback.resize(used + read_chunk);
+			ssize_t count = ::read(fd, fallback.data() + used, read_chunk);
+			if (count < 0) {
+				return false;
+			}
+			if (count == 0) {
+				break;
+			}
+			used += static_cast<size_t>(count);
+		}
+		fallback.resize(used);
+		return true;
+	}
+#endif
+
+public:
+	explicit source_buffer(const char* path) {
+#ifdef _WIN32
+		std::ifstream in(path, std::ios::binary);
+		if (in) {
+			fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+			is_open = true;
+		}
+#else
+		int fd = ::open(path, O_RDONLY);
+		if (fd < 0) {
+			return;
+		}
+		struct stat info;
+		if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 && map(fd, static_cast<size_t>(info.st_size))) {
+			is_open = true;
+		} else {
+			is_open = read_all(fd);
+		}
+		::close(fd);
+#endif
+	}
+	source_buffer(const source_buffer&) = delete;
+	source_buffer& operator=(const source_buffer&) = delete;
+	~source_buffer() {
+#ifndef _WIN32
+		if (mapping) {
+			::munmap(mapping, mapping_size);
+		}
+#endif
+	}
+
+	bool good() const {
+		return is_open;
+	}
+	bool mapped() const {
+		return mapping != nullptr;
+	}
+	std::string_view view() const {
+		if (mapping) {
+			return std::string_view(static_cast<const char*>(mapping), mapping_size);
+		}
+		return fallback;
+	}
+
+private:
+	void* mapping { nullptr };
+	size_t mapping_size { 0 };
+	std::string fallback;
+	bool is_open { false };
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include "parser.hpp"
+#include "context.hpp"
+
+
+class type_checker {
+private:
+	struct state {
+		context& con;
+		std::map<std::string_view, ast_node_function*> functions;
+		std::vector<context::var_type> types;
+		std::vector<lexer::token_type> modifiers;
+		context::var_type return_type;
+		bool returns_typed;
+		int loop_depth;
+	};
+
+	static context::var_type array_of(context::var_type type);
+	static context::var_type element_of(context::var_type type);
+	static bool is_operable(ast_node_bin::op_type op, context::var_type type);
+	static void report(code_point point, const std::string& message);
+
+	static ast_node_function* find_function(state& st, const std::string& name);
+	static context::var_type type_of_var(state& st, int depth, int slot);
+	static void declare(state& st, int depth, int slot, context::var_type type, lexer::token_type modifier);
+
+	static context::var_type check_value(state& st, ast_node_value* node);
+	static context::var_type check_call(state& st, ast_node_call_function* node);
+	static context::var_type check_assign(state& st, ast_node_bin* node);
+	static context::var_type check_bin(state& st, ast_node_bin* node);
+	static context::var_type check_initial_list(state& st, ast_node_initial_list* node);
+	static void check_var_definition(state& st, ast_node_var_definition* node);
+	static void check_condition(state& st, ast_node_base* node, ast_node_base* condition);
+	static context::var_type check_node(state& st, ast_node_base* node);
+	static void check_function(state& st, ast_node_function* node);
+public:
+	static void check(context& con, ast_node_base* root);
+	static void check(context& con, ast_node_function* node);
+};
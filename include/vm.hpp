@@ -0,0 +1,18 @@
+#pragma once
+#include "compiler.hpp"
+
+
+class vm {
+private:
+	struct frame {
+		int return_address;
+		int function;
+		size_t stack_base;
+		size_t caller_base;
+	};
+	static OBJECT binary(opcode op, OBJECT& lhs, OBJECT& rhs);
+	static void run(context& con, const bytecode& program, int ip, std::vector<frame>& frames);
+public:
+	static OBJECT execute(context& con, const bytecode& program);
+	static OBJECT call(context& con, const bytecode& program, const std::string& name);
+};
@@ -0,0 +1,494 @@
+#include "ast_cache.hpp"
+#include "resolver.hpp"
+#include "constant_folder.hpp"
+#include "type_checker.hpp"
+#include "source_buffer.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+
+uint64_t ast_cache::hash(std::string_view source) {
+	uint64_t value = 0x9E3779B97F4A7C15ull ^ source.size();
+	size_t i = 0;
+	for (; i + 8 <= source.size(); i += 8) {
+		uint64_t word;
+		std::memcpy(&word, source.data() + i, 8);
+		value = (value ^ word) * 0xFF51AFD7ED558CCDull;
+		value ^= value >> 32;
+	}
+	for (; i < source.size(); ++i) {
+		value = (value ^ static_cast<unsigned char>(source[i])) * 0xC4CEB9FE1A85EC53ull;
+	}
+	value ^= value >> 33;
+	value *= 0xFF51AFD7ED558CCDull;
+	value ^= value >> 33;
+	return value;
+}
+
+std::string ast_cache::path_for(const char* source_path, uint64_t source_hash) {
+	const char* directory = std::getenv("SSK_CACHE_DIR");
+	if (!directory || !*directory) {
+		return std::string(source_path) + ".sskc";
+	}
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.sskc", static_cast<unsigned long long>(source_hash));
+	return std::string(directory) + "/" + name;
+}
+
+void ast_cache::write_bytes(writer& out, const void* data, size_t size) {
+	out.buffer.append(static_cast<const char*>(data), size);
+}
+
+void ast_cache::write_u8(writer& out, unsigned char value) {
+	out.buffer.push_back(static_cast<char>(value));
+}
+
+void ast_cache::write_u32(writer& out, uint32_t value) {
+	write_bytes(out, &value, sizeof(value));
+}
+
+void ast_cache::write_string(writer& out, std::string_view value) {
+	write_u32(out, static_cast<uint32_t>(value.size()));
+	write_bytes(out, value.data(), value.size());
+}
+
+void ast_cache::write_point(writer& out, code_point point) {
+	write_u32(out, point.line);
+	write_u32(out, point.col);
+}
+
+void ast_cache::write_lexeme(writer& out, const lexer::lexeme& value) {
+	std::less_equal<const char*> before;
+	if (before(out.source.data(), value.raw.data()) && before(value.raw.data() + value.raw.size(), out.source.data() + out.source.size())) {
+		write_u32(out, static_cast<uint32_t>(value.raw.data() - out.source.data()));
+		write_u32(out, static_cast<uint32_t>(value.raw.size()));
+	} else {
+		write_u32(out, null_index);
+		write_string(out, value.raw);
+	}
+	write_u8(out, static_cast<unsigned char>(value.type));
+	write_point(out, value.point);
+}
+
+void ast_cache::write_ref(writer& out, const ast_node_base* node) {
+	write_u32(out, node ? out.indices.at(node) : null_index);
+}
+
+void ast_cache::write_refs(writer& out, const std::vector<ast_node_base*>& nodes) {
+	write_u32(out, static_cast<uint32_t>(nodes.size()));
+	for (const ast_node_base* node : nodes) {
+		write_ref(out, node);
+	}
+}
+
+uint32_t ast_cache::write_node(writer& out, const ast_node_base* node) {
+	if (!node) {
+		return null_index;
+	}
+	if (is_a<ast_node_error>(node)) {
+		const ast_node_error* error = static_cast<const ast_node_error*>(node);
+		write_u8(out, static_cast<unsigned char>(record::error));
+		write_point(out, error->point);
+		write_string(out, error->text);
+	} else if (is_a<ast_node_string>(node)) {
+		const ast_node_string* string = static_cast<const ast_node_string*>(node);
+		write_u8(out, static_cast<unsigned char>(record::string));
+		write_point(out, string->point);
+		write_lexeme(out, string->value);
+	} else if (is_a<ast_node_value>(node)) {
+		const ast_node_value* value = static_cast<const ast_node_value*>(node);
+		write_u8(out, static_cast<unsigned char>(record::value));
+		write_point(out, value->point);
+		write_lexeme(out, value->value);
+	} else if (is_a<ast_node_call_function>(node)) {
+		const ast_node_call_function* call = static_cast<const ast_node_call_function*>(node);
+		for (const ast_node_base* arg : call->arguments) {
+			write_node(out, arg);
+		}
+		write_u8(out, static_cast<unsigned char>(record::call_function));
+		write_point(out, call->point);
+		write_string(out, call->function_name);
+		write_refs(out, call->arguments);
+	} else if (is_a<ast_node_bin>(node)) {
+		const ast_node_bin* bin = static_cast<const ast_node_bin*>(node);
+		write_node(out, bin->lhs);
+		write_node(out, bin->rhs);
+		write_u8(out, static_cast<unsigned char>(record::bin));
+		write_point(out, bin->point);
+		write_u8(out, static_cast<unsigned char>(bin->op));
+		write_ref(out, bin->lhs);
+		write_ref(out, bin->rhs);
+	} else if (is_a<ast_node_expr>(node)) {
+		const ast_node_expr* expr = static_cast<const ast_node_expr*>(node);
+		write_node(out, expr->expr);
+		write_u8(out, static_cast<unsigned char>(record::expr));
+		write_point(out, expr->point);
+		write_ref(out, expr->expr);
+	} else if (is_a<ast_node_return>(node)) {
+		const ast_node_return* ret = static_cast<const ast_node_return*>(node);
+		write_node(out, ret->value);
+		write_u8(out, static_cast<unsigned char>(record::_return));
+		write_point(out, ret->point);
+		write_ref(out, ret->value);
+	} else if (is_a<ast_node_block>(node)) {
+		const ast_node_block* block = static_cast<const ast_node_block*>(node);
+		for (const ast_node_base* item : block->exprs) {
+			write_node(out, item);
+		}
+		write_u8(out, static_cast<unsigned char>(record::block));
+		write_point(out, block->point);
+		write_string(out, block->block_name);
+		write_refs(out, block->exprs);
+	} else if (is_a<ast_node_function>(node)) {
+		const ast_node_function* func = static_cast<const ast_node_function*>(node);
+		write_node(out, func->block);
+		write_u8(out, static_cast<unsigned char>(record::function));
+		write_point(out, func->point);
+		write_string(out, func->function_name);
+		write_u8(out, static_cast<unsigned char>(func->return_type));
+		write_u32(out, static_cast<uint32_t>(func->return_type_size));
+		write_u32(out, static_cast<uint32_t>(func->arguments.size()));
+		for (const context::var_info& arg : func->arguments) {
+			write_u8(out, static_cast<unsigned char>(arg.modifier));
+			write_u8(out, static_cast<unsigned char>(arg.type));
+			write_string(out, arg.name);
+		}
+		write_ref(out, func->block);
+		write_u8(out, func->lazy ? 1 : 0);
+		if (func->lazy) {
+			write_lexeme(out, func->lazy->open);
+			write_lexeme(out, func->lazy->name);
+		}
+	} else if (is_a<ast_node_repeat>(node)) {
+		const ast_node_repeat* repeat = static_cast<const ast_node_repeat*>(node);
+		write_node(out, repeat->bgn);
+		write_node(out, repeat->end);
+		write_u8(out, static_cast<unsigned char>(record::repeat));
+		write_point(out, repeat->point);
+		write_ref(out, repeat->bgn);
+		write_ref(out, repeat->end);
+	} else if (is_a<ast_node_array_refernce>(node)) {
+		const ast_node_array_refernce* reference = static_cast<const ast_node_array_refernce*>(node);
+		write_node(out, reference->index);
+		write_u8(out, static_cast<unsigned char>(record::array_reference));
+		write_point(out, reference->point);
+		write_lexeme(out, reference->name);
+		write_ref(out, reference->index);
+	} else if (is_a<ast_node_var_definition>(node)) {
+		const ast_node_var_definition* definition = static_cast<const ast_node_var_definition*>(node);
+		write_node(out, definition->init_value);
+		write_u8(out, static_cast<unsigned char>(record::var_definition));
+		write_point(out, definition->point);
+		write_u8(out, static_cast<unsigned char>(definition->modifier));
+		write_string(out, definition->name);
+		write_u8(out, static_cast<unsigned char>(definition->type));
+		write_u32(out, static_cast<uint32_t>(definition->size));
+		write_ref(out, definition->init_value);
+	} else if (is_a<ast_node_if>(node)) {
+		const ast_node_if* branch = static_cast<const ast_node_if*>(node);
+		write_node(out, branch->condition_block);
+		write_node(out, branch->true_block);
+		write_node(out, branch->false_block);
+		write_u8(out, static_cast<unsigned char>(record::_if));
+		write_point(out, branch->point);
+		write_ref(out, branch->condition_block);
+		write_ref(out, branch->true_block);
+		write_ref(out, branch->false_block);
+	} else if (is_a<ast_node_while>(node)) {
+		const ast_node_while* loop = static_cast<const ast_node_while*>(node);
+		write_node(out, loop->condition);
+		write_node(out, loop->block);
+		write_u8(out, static_cast<unsigned char>(record::_while));
+		write_point(out, loop->point);
+		write_ref(out, loop->condition);
+		write_ref(out, loop->block);
+	} else if (is_a<ast_node_do_while>(node)) {
+		const ast_node_do_while* loop = static_cast<const ast_node_do_while*>(node);
+		write_node(out, loop->condition);
+		write_node(out, loop->block);
+		write_u8(out, static_cast<unsigned char>(record::do_while));
+		write_point(out, loop->point);
+		write_ref(out, loop->condition);
+		write_ref(out, loop->block);
+	} else if (is_a<ast_node_initial_list>(node)) {
+		const ast_node_initial_list* list = static_cast<const ast_node_initial_list*>(node);
+		for (const ast_node_base* value : list->values) {
+			write_node(out, value);
+		}
+		write_u8(out, static_cast<unsigned char>(record::initial_list));
+		write_point(out, list->point);
+		write_refs(out, list->values);
+	} else if (is_a<ast_node_class>(node)) {
+		const ast_node_class* klass = static_cast<const ast_node_class*>(node);
+		write_node(out, klass->block);
+		write_u8(out, static_cast<unsigned char>(record::_class));
+		write_point(out, klass->point);
+		write_lexeme(out, klass->name);
+		write_ref(out, klass->block);
+	} else if (is_a<ast_node_program>(node)) {
+		const ast_node_program* program = static_cast<const ast_node_program*>(node);
+		for (const ast_node_base* item : program->exprs) {
+			write_node(out, item);
+		}
+		write_u8(out, static_cast<unsigned char>(record::program));
+		write_point(out, program->point);
+		write_refs(out, program->exprs);
+	} else {
+		return null_index;
+	}
+	out.indices[node] = out.count;
+	return out.count++;
+}
+
+bool ast_cache::store(const std::string& path, uint64_t source_hash, std::string_view source, const ast_tree& tree, const context& con) {
+	writer out { .source = source, .buffer = std::string(sizeof(header), '\0'), .indices = {}, .count = 0 };
+	uint32_t root = write_node(out, tree.root);
+	if (root == null_index) {
+		return false;
+	}
+	write_u32(out, static_cast<uint32_t>(con.pre_evaluate.size()));
+	for (const ast_node_base* node : con.pre_evaluate) {
+		if (out.indices.find(node) == out.indices.end()) {
+			return false;
+		}
+		write_ref(out, node);
+	}
+
+	header head { .magic = {}, .version = version, .source_hash = source_hash, .source_size = source.size(), .node_count = out.count, .root = root, .function_count = static_cast<uint32_t>(con.pre_evaluate.size()), .reserved = 0 };
+	std::memcpy(head.magic, magic, sizeof(magic));
+	std::memcpy(out.buffer.data(), &head, sizeof(head));
+
+	std::string temporary = path + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		if (!file || !file.write(out.buffer.data(), out.buffer.size())) {
+			return false;
+		}
+	}
+	return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool ast_cache::read_bytes(reader& in, void* data, size_t size) {
+	if (in.failed || static_cast<size_t>(in.end - in.itr) < size) {
+		in.failed = true;
+		std::memset(data, 0, size);
+		return false;
+	}
+	std::memcpy(data, in.itr, size);
+	in.itr += size;
+	return true;
+}
+
+unsigned char ast_cache::read_u8(reader& in) {
+	unsigned char value;
+	read_bytes(in, &value, sizeof(value));
+	return value;
+}
+
+uint32_t ast_cache::read_u32(reader& in) {
+	uint32_t value;
+	read_bytes(in, &value, sizeof(value));
+	return value;
+}
+
+std::string ast_cache::read_string(reader& in) {
+	uint32_t size = read_u32(in);
+	if (in.failed || static_cast<size_t>(in.end - in.itr) < size) {
+		in.failed = true;
+		return std::string();
+	}
+	std::string value(in.itr, size);
+	in.itr += size;
+	return value;
+}
+
+code_point ast_cache::read_point(reader& in) {
+	code_point point;
+	point.line = read_u32(in);
+	point.col = read_u32(in);
+	return point;
+}
+
+lexer::lexeme ast_cache::read_lexeme(reader& in) {
+	uint32_t offset = read_u32(in);
+	if (offset == null_index) {
+		std::string text = read_string(in);
+		lexer::token_type type = static_cast<lexer::token_type>(read_u8(in));
+		code_point point = read_point(in);
+		return lexer::lexeme { .raw = in.arena->copy(text), .type = type, .point = point };
+	}
+	uint32_t length = read_u32(in);
+	lexer::token_type type = static_cast<lexer::token_type>(read_u8(in));
+	code_point point = read_point(in);
+	if (static_cast<size_t>(offset) + length > in.source.size()) {
+		in.failed = true;
+		return lexer::lexeme { .raw = std::string_view(), .type = type, .point = point };
+	}
+	return lexer::lexeme { .raw = in.source.substr(offset, length), .type = type, .point = point };
+}
+
+ast_node_base* ast_cache::read_ref(reader& in) {
+	uint32_t index = read_u32(in);
+	if (index == null_index) {
+		return nullptr;
+	}
+	if (index >= in.nodes.size()) {
+		in.failed = true;
+		return nullptr;
+	}
+	return in.nodes[index];
+}
+
+std::vector<ast_node_base*> ast_cache::read_refs(reader& in) {
+	uint32_t size = read_u32(in);
+	std::vector<ast_node_base*> nodes;
+	if (size > static_cast<size_t>(in.end - in.itr) / sizeof(uint32_t)) {
+		in.failed = true;
+		return nodes;
+	}
+	nodes.reserve(size);
+	for (uint32_t i = 0; i < size; ++i) {
+		nodes.push_back(read_ref(in));
+	}
+	return nodes;
+}
+
+ast_node_base* ast_cache::read_node(reader& in, ast_arena& arena) {
+	record kind = static_cast<record>(read_u8(in));
+	code_point point = read_point(in);
+	if (in.failed) {
+		return nullptr;
+	}
+	switch (kind) {
+	case record::error: {
+		std::string text = read_string(in);
+		return arena.make<ast_node_error>(text, point);
+	}
+	case record::string:
+		return arena.make<ast_node_string>(read_lexeme(in), point);
+	case record::value:
+		return arena.make<ast_node_value>(read_lexeme(in), point);
+	case record::call_function: {
+		std::string name = read_string(in);
+		return arena.make<ast_node_call_function>(name, read_refs(in), point);
+	}
+	case record::bin: {
+		ast_node_bin* bin = arena.make<ast_node_bin>();
+		bin->point = point;
+		unsigned char op = read_u8(in);
+		if (op > static_cast<unsigned char>(ast_node_bin::op_type::greater_than_or_equal)) {
+			in.failed = true;
+		}
+		bin->op = static_cast<ast_node_bin::op_type>(op);
+		bin->lhs = read_ref(in);
+		bin->rhs = read_ref(in);
+		return bin;
+	}
+	case record::expr:
+		return arena.make<ast_node_expr>(read_ref(in), point);
+	case record::_return:
+		return arena.make<ast_node_return>(read_ref(in), point);
+	case record::block: {
+		std::string name = read_string(in);
+		return arena.make<ast_node_block>(read_refs(in), name, point);
+	}
+	case record::function: {
+		ast_node_function* func = arena.make<ast_node_function>();
+		func->point = point;
+		func->function_name = read_string(in);
+		func->return_type = static_cast<context::var_type>(read_u8(in));
+		func->return_type_size = static_cast<int>(read_u32(in));
+		uint32_t count = read_u32(in);
+		for (uint32_t i = 0; i < count && !in.failed; ++i) {
+			context::var_info arg;
+			arg.modifier = static_cast<lexer::token_type>(read_u8(in));
+			arg.type = static_cast<context::var_type>(read_u8(in));
+			arg.name = read_string(in);
+			func->arguments.push_back(arg);
+		}
+		func->block = read_ref(in);
+		if (read_u8(in)) {
+			lexer::lexeme open = read_lexeme(in);
+			func->lazy = ast_node_function::lazy_body { .source = in.source, .open = open, .name = read_lexeme(in), .arena = &arena };
+		}
+		return func;
+	}
+	case record::repeat: {
+		ast_node_base* bgn = read_ref(in);
+		return arena.make<ast_node_repeat>(bgn, read_ref(in), point);
+	}
+	case record::array_reference: {
+		lexer::lexeme name = read_lexeme(in);
+		return arena.make<ast_node_array_refernce>(name, read_ref(in), point);
+	}
+	case record::var_definition: {
+		lexer::token_type modifier = static_cast<lexer::token_type>(read_u8(in));
+		std::string name = read_string(in);
+		context::var_type type = static_cast<context::var_type>(read_u8(in));
+		int size = static_cast<int>(read_u32(in));
+		return arena.make<ast_node_var_definition>(modifier, name, type, size, read_ref(in), point);
+	}
+	case record::_if: {
+		ast_node_base* condition = read_ref(in);
+		ast_node_base* true_block = read_ref(in);
+		ast_node_if* branch = arena.make<ast_node_if>(condition, true_block, read_ref(in));
+		branch->point = point;
+		return branch;
+	}
+	case record::_while: {
+		ast_node_base* condition = read_ref(in);
+		return arena.make<ast_node_while>(condition, read_ref(in), point);
+	}
+	case record::do_while: {
+		ast_node_base* condition = read_ref(in);
+		return arena.make<ast_node_do_while>(condition, read_ref(in), point);
+	}
+	case record::initial_list:
+		return arena.make<ast_node_initial_list>(read_refs(in), point);
+	case record::_class: {
+		lexer::lexeme name = read_lexeme(in);
+		return arena.make<ast_node_class>(name, read_ref(in), point);
+	}
+	case record::program:
+		return arena.make<ast_node_program>(read_refs(in), point);
+	}
+	in.failed = true;
+	return nullptr;
+}
+
+ast_tree ast_cache::load(const std::string& path, uint64_t source_hash, std::string_view source, context& con) {
+	source_buffer file(path.c_str());
+	std::string_view data = file.view();
+	header head;
+	if (!file.good() || data.size() < sizeof(head)) {
+		return ast_tree {};
+	}
+	std::memcpy(&head, data.data(), sizeof(head));
+	if (std::memcmp(head.magic, magic, sizeof(magic)) || head.version != version || head.source_hash != source_hash || head.source_size != source.size()) {
+		return ast_tree {};
+	}
+
+	ast_tree tree { .arena = std::make_unique<ast_arena>(), .root = nullptr };
+	reader in { .source = source, .itr = data.data() + sizeof(head), .end = data.data() + data.size(), .nodes = {}, .arena = tree.arena.get(), .failed = false };
+	in.nodes.reserve(head.node_count);
+	for (uint32_t i = 0; i < head.node_count && !in.failed; ++i) {
+		in.nodes.push_back(read_node(in, *tree.arena));
+	}
+	std::vector<ast_node_base*> functions;
+	uint32_t function_count = read_u32(in);
+	for (uint32_t i = 0; i < function_count && !in.failed; ++i) {
+		functions.push_back(read_ref(in));
+	}
+	if (in.failed || in.itr != in.end || head.root >= in.nodes.size() || function_count != head.function_count) {
+		return ast_tree {};
+	}
+	tree.root = in.nodes[head.root];
+	con.pre_evaluate = std::move(functions);
+	resolver::resolve(con, tree.root);
+	constant_folder::fold(con, *tree.arena, tree.root);
+	type_checker::check(con, tree.root);
+	return tree;
+}
@@ -0,0 +1,685 @@
+#include "ast_dump.hpp"
+#include <algorithm>
+#include <charconv>
+
+
+void ast_dump::sink::spill(const char* data, size_t size) {
+	while (size) {
+		if (used == buffer_size) {
+			flush();
+		}
+		size_t count = std::min(size, buffer_size - used);
+		std::memcpy(buffer + used, data, count);
+		used += count;
+		data += count;
+		size -= count;
+	}
+}
+
+void ast_dump::sink::number(long long value) {
+	char digits[24];
+	std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+	put(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+void ast_dump::sink::indent(int depth) {
+	static constexpr std::string_view tabs = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+	for (; depth > static_cast<int>(tabs.size()); depth -= static_cast<int>(tabs.size())) {
+		put(tabs);
+	}
+	put(tabs.substr(0, depth));
+}
+
+void ast_dump::sink::flush() {
+	if (used) {
+		out.write(buffer, static_cast<std::streamsize>(used));
+		used = 0;
+	}
+}
+
+const char* ast_dump::type_name(context::var_type type) {
+	switch (type) {
+	case context::var_type::_int: return "int";
+	case context::var_type::_float: return "float";
+	case context::var_type::_bool: return "bool";
+	case context::var_type::_str: return "str";
+	case context::var_type::_int_array: return "int[]";
+	case context::var_type::_float_array: return "float[]";
+	case context::var_type::_bool_array: return "bool[]";
+	case context::var_type::_str_array: return "str[]";
+	default: return "";
+	}
+}
+
+const char* ast_dump::modifier_name(lexer::token_type modifier) {
+	switch (modifier) {
+	case lexer::token_type::_mut: return "mut";
+	case lexer::token_type::_const: return "const";
+	default: return "";
+	}
+}
+
+const char* ast_dump::kind_name(node_kind kind) {
+	static const char* names[] = {
+		"base", "error", "string", "value", "call_function", "bin", "expr", "return", "block", "function",
+		"repeat", "array_reference", "var_definition", "if", "while", "do_while", "initial_list", "class", "program",
+	};
+	return names[static_cast<uint8_t>(kind)];
+}
+
+void ast_dump::xml_line(sink& out, int depth, std::string_view text) {
+	out.indent(depth);
+	out.put(text);
+	out.put('\n');
+}
+
+void ast_dump::xml_block(sink& out, const ast_node_base* node, std::string_view name, int depth) {
+	out.indent(depth);
+	out.put('<');
+	out.put(name);
+	out.put(">\n");
+	for (const ast_node_base* item : static_cast<const ast_node_block*>(node)->exprs) {
+		xml_node(out, item, depth + 1);
+	}
+	out.indent(depth);
+	out.put("</");
+	out.put(name);
+	out.put(">\n");
+}
+
+void ast_dump::xml_node(sink& out, const ast_node_base* node, int depth) {
+	if (!node) {
+		return;
+	}
+	switch (node->kind) {
+	case node_kind::error: {
+		const ast_node_error* error = static_cast<const ast_node_error*>(node);
+		out.indent(depth);
+		out.put("<error code_point=(");
+		out.number(error->point.line);
+		out.put(',');
+		out.number(error->point.col);
+		out.put(")>");
+		out.put(error->text);
+		out.put("</error>\n");
+		break;
+	}
+	case node_kind::string:
+	case node_kind::value: {
+		std::string_view raw = is_a<ast_node_string>(node) ? static_cast<const ast_node_string*>(node)->value.raw : static_cast<const ast_node_value*>(node)->value.raw;
+		out.indent(depth);
+		out.put("<value>");
+		out.put(raw);
+		out.put("</value>\n");
+		break;
+	}
+	case node_kind::call_function: {
+		const ast_node_call_function* call = static_cast<const ast_node_call_function*>(node);
+		out.indent(depth);
+		out.put("<call_function name=\"");
+		out.put(call->function_name);
+		out.put("\">\n");
+		xml_line(out, depth + 1, "<arguments>");
+		for (const ast_node_base* arg : call->arguments) {
+			xml_node(out, arg, depth + 2);
+		}
+		xml_line(out, depth + 1, "</arguments>");
+		xml_line(out, depth, "</call_function>");
+		break;
+	}
+	case node_kind::bin: {
+		const ast_node_bin* bin = static_cast<const ast_node_bin*>(node);
+		out.indent(depth);
+		out.put("<bin op=\"");
+		out.put(ast_node_bin::sign_of(bin->op));
+		out.put("\">\n");
+		for (const ast_node_base* operand : { bin->lhs, bin->rhs }) {
+			if (operand) {
+				xml_node(out, operand, depth + 1);
+			} else {
+				xml_line(out, depth + 1, "<value>error</value>");
+			}
+		}
+		xml_line(out, depth, "</bin>");
+		break;
+	}
+	case node_kind::expr: {
+		const ast_node_expr* expr = static_cast<const ast_node_expr*>(node);
+		if (expr->expr) {
+			xml_node(out, expr->expr, depth);
+		} else {
+			xml_line(out, depth, "<expr>error</expr>");
+		}
+		break;
+	}
+	case node_kind::_return: {
+		const ast_node_return* ret = static_cast<const ast_node_return*>(node);
+		xml_line(out, depth, "<return>");
+		if (ret->value) {
+			xml_node(out, ret->value, depth + 1);
+		} else {
+			xml_line(out, depth + 1, "<error>no expression</error>");
+		}
+		xml_line(out, depth, "</return>");
+		break;
+	}
+	case node_kind::block:
+		xml_block(out, node, static_cast<const ast_node_block*>(node)->block_name, depth);
+		break;
+	case node_kind::function: {
+		const ast_node_function* func = static_cast<const ast_node_function*>(node);
+		out.indent(depth);
+		out.put("<function name=");
+		out.put(func->function_name);
+		out.put(">\n");
+		out.indent(depth + 1);
+		out.put("<return type=\"");
+		out.put(func->return_type == context::var_type::_invalid ? "invalid" : type_name(func->return_type));
+		out.put("\"></return>\n");
+		for (const context::var_info& arg : func->arguments) {
+			out.indent(depth + 1);
+			out.put("<argument type=\"");
+			out.put(modifier_name(arg.modifier));
+			if (arg.type != context::var_type::_invalid) {
+				out.put(' ');
+				out.put(type_name(arg.type));
+			}
+			out.put("\">");
+			out.put(arg.name);
+			out.put("</argument>\n");
+		}
+		if (func->block) {
+			if (is_a<ast_node_block>(func->block)) {
+				xml_block(out, func->block, "implement", depth + 1);
+			}
+		} else if (func->lazy) {
+			xml_line(out, depth + 1, "<implement lazy=\"true\"></implement>");
+		}
+		xml_line(out, depth, "</function>");
+		break;
+	}
+	case node_kind::repeat: {
+		const ast_node_repeat* repeat = static_cast<const ast_node_repeat*>(node);
+		xml_line(out, depth, "<repeat>");
+		xml_node(out, repeat->bgn, depth + 1);
+		xml_node(out, repeat->end, depth + 1);
+		xml_line(out, depth, "</repeat>");
+		break;
+	}
+	case node_kind::array_reference: {
+		const ast_node_array_refernce* reference = static_cast<const ast_node_array_refernce*>(node);
+		xml_line(out, depth, "<array-reference>");
+		out.indent(depth + 1);
+		out.put("<variable>");
+		out.put(reference->name.raw);
+		out.put("</variable>\n");
+		xml_line(out, depth + 1, "<index>");
+		xml_node(out, reference->index, depth + 2);
+		xml_line(out, depth + 1, "</index>");
+		xml_line(out, depth, "</array-reference>");
+		break;
+	}
+	case node_kind::var_definition: {
+		const ast_node_var_definition* definition = static_cast<const ast_node_var_definition*>(node);
+		out.indent(depth);
+		out.put("<define type=\"");
+		out.put(modifier_name(definition->modifier));
+		if (definition->type != context::var_type::_invalid) {
+			std::string_view element = type_name(definition->type);
+			if (definition->size >= 0 && element.ends_with("[]")) {
+				element.remove_suffix(2);
+			}
+			out.put(' ');
+			out.put(element);
+		}
+		if (definition->size > 0) {
+			out.put('[');
+			out.number(definition->size);
+			out.put(']');
+		} else if (!definition->size) {
+			out.put("[]");
+		}
+		out.put("\">\n");
+		out.indent(depth + 1);
+		out.put("<name>");
+		out.put(definition->name);
+		out.put("</name>\n");
+		if (definition->init_value) {
+			xml_line(out, depth + 1, "<init>");
+			xml_node(out, definition->init_value, depth + 2);
+			xml_line(out, depth + 1, "</init>");
+		}
+		xml_line(out, depth, "</define>");
+		break;
+	}
+	case node_kind::_if: {
+		const ast_node_if* branch = static_cast<const ast_node_if*>(node);
+		xml_line(out, depth, "<if>");
+		xml_line(out, depth + 1, "<condition>");
+		xml_node(out, branch->condition_block, depth + 2);
+		xml_line(out, depth + 1, "</condition>");
+		if (branch->true_block) {
+			xml_node(out, branch->true_block, depth + 1);
+		} else {
+			xml_line(out, depth + 1, "<expr>error</expr>");
+		}
+		xml_node(out, branch->false_block, depth + 1);
+		xml_line(out, depth, "</if>");
+		break;
+	}
+	case node_kind::_while:
+	case node_kind::do_while: {
+		bool is_while = is_a<ast_node_while>(node);
+		const ast_node_base* condition = is_while ? static_cast<const ast_node_while*>(node)->condition : static_cast<const ast_node_do_while*>(node)->condition;
+		const ast_node_base* block = is_while ? static_cast<const ast_node_while*>(node)->block : static_cast<const ast_node_do_while*>(node)->block;
+		xml_line(out, depth, is_while ? "<while>" : "<do-while>");
+		xml_line(out, depth + 1, "<condition>");
+		xml_node(out, condition, depth + 2);
+		xml_line(out, depth + 1, "</condition>");
+		xml_node(out, block, depth + 1);
+		xml_line(out, depth, is_while ? "</while>" : "</do-while>");
+		break;
+	}
+	case node_kind::initial_list: {
+		xml_line(out, depth, "<initialize>");
+		for (const ast_node_base* value : static_cast<const ast_node_initial_list*>(node)->values) {
+			xml_line(out, depth + 1, "<value>");
+			xml_node(out, value, depth + 2);
+			xml_line(out, depth + 1, "</value>");
+		}
+		xml_line(out, depth, "</initialize>");
+		break;
+	}
+	case node_kind::_class: {
+		const ast_node_class* klass = static_cast<const ast_node_class*>(node);
+		out.indent(depth);
+		out.put("<class name=\"");
+		out.put(klass->name.raw);
+		out.put("\">\n");
+		xml_node(out, klass->block, depth + 1);
+		xml_line(out, depth, "</class>");
+		break;
+	}
+	case node_kind::program: {
+		const ast_node_program* program = static_cast<const ast_node_program*>(node);
+		xml_line(out, depth, "<program>");
+		if (program->exprs.size()) {
+			for (const ast_node_base* item : program->exprs) {
+				xml_node(out, item, depth + 1);
+			}
+		} else {
+			xml_line(out, depth + 1, "<expr>error</expr>");
+		}
+		xml_line(out, depth, "</program>");
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void ast_dump::json_string(sink& out, std::string_view text) {
+	static constexpr char hex[] = "0123456789abcdef";
+	out.put('"');
+	size_t run = 0;
+	for (size_t i = 0; i < text.size(); ++i) {
+		unsigned char code = static_cast<unsigned char>(text[i]);
+		if (code >= 0x20 && code != '"' && code != '\\') {
+			continue;
+		}
+		out.put(text.substr(run, i - run));
+		run = i + 1;
+		if (code < 0x20) {
+			out.put("\\u00");
+			out.put(hex[code >> 4]);
+			out.put(hex[code & 0xF]);
+		} else {
+			out.put('\\');
+			out.put(static_cast<char>(code));
+		}
+	}
+	out.put(text.substr(run));
+	out.put('"');
+}
+
+void ast_dump::json_key(sink& out, std::string_view key) {
+	out.put(",\"");
+	out.put(key);
+	out.put("\":");
+}
+
+void ast_dump::json_nodes(sink& out, std::string_view key, const std::vector<ast_node_base*>& nodes) {
+	json_key(out, key);
+	out.put('[');
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (i) {
+			out.put(',');
+		}
+		json_node(out, nodes[i]);
+	}
+	out.put(']');
+}
+
+void ast_dump::json_node(sink& out, const ast_node_base* node) {
+	if (!node) {
+		out.put("null");
+		return;
+	}
+	out.put("{\"kind\":\"");
+	out.put(kind_name(node->kind));
+	out.put("\",\"line\":");
+	out.number(node->point.line);
+	out.put(",\"col\":");
+	out.number(node->point.col);
+	switch (node->kind) {
+	case node_kind::error:
+		json_key(out, "text");
+		json_string(out, static_cast<const ast_node_error*>(node)->text);
+		break;
+	case node_kind::string:
+		json_key(out, "value");
+		json_string(out, static_cast<const ast_node_string*>(node)->value.raw);
+		break;
+	case node_kind::value:
+		json_key(out, "value");
+		json_string(out, static_cast<const ast_node_value*>(node)->value.raw);
+		break;
+	case node_kind::call_function: {
+		const ast_node_call_function* call = static_cast<const ast_node_call_function*>(node);
+		json_key(out, "name");
+		json_string(out, call->function_name);
+		json_nodes(out, "arguments", call->arguments);
+		break;
+	}
+	case node_kind::bin: {
+		const ast_node_bin* bin = static_cast<const ast_node_bin*>(node);
+		json_key(out, "op");
+		json_string(out, ast_node_bin::sign_of(bin->op));
+		json_key(out, "lhs");
+		json_node(out, bin->lhs);
+		json_key(out, "rhs");
+		json_node(out, bin->rhs);
+		break;
+	}
+	case node_kind::expr:
+		json_key(out, "expr");
+		json_node(out, static_cast<const ast_node_expr*>(node)->expr);
+		break;
+	case node_kind::_return:
+		json_key(out, "value");
+		json_node(out, static_cast<const ast_node_return*>(node)->value);
+		break;
+	case node_kind::block: {
+		const ast_node_block* block = static_cast<const ast_node_block*>(node);
+		json_key(out, "name");
+		json_string(out, block->block_name);
+		json_nodes(out, "body", block->exprs);
+		break;
+	}
+	case node_kind::function: {
+		const ast_node_function* func = static_cast<const ast_node_function*>(node);
+		json_key(out, "name");
+		json_string(out, func->function_name);
+		json_key(out, "return");
+		json_string(out, type_name(func->return_type));
+		json_key(out, "arguments");
+		out.put('[');
+		for (size_t i = 0; i < func->arguments.size(); ++i) {
+			const context::var_info& arg = func->arguments[i];
+			out.put(i ? ",{\"modifier\":" : "{\"modifier\":");
+			json_string(out, modifier_name(arg.modifier));
+			json_key(out, "type");
+			json_string(out, type_name(arg.type));
+			json_key(out, "name");
+			json_string(out, arg.name);
+			out.put('}');
+		}
+		out.put(']');
+		json_key(out, "body");
+		json_node(out, func->block);
+		json_key(out, "lazy");
+		out.put(!func->block && func->lazy ? "true" : "false");
+		break;
+	}
+	case node_kind::repeat: {
+		const ast_node_repeat* repeat = static_cast<const ast_node_repeat*>(node);
+		json_key(out, "begin");
+		json_node(out, repeat->bgn);
+		json_key(out, "end");
+		json_node(out, repeat->end);
+		break;
+	}
+	case node_kind::array_reference: {
+		const ast_node_array_refernce* reference = static_cast<const ast_node_array_refernce*>(node);
+		json_key(out, "name");
+		json_string(out, reference->name.raw);
+		json_key(out, "index");
+		json_node(out, reference->index);
+		break;
+	}
+	case node_kind::var_definition: {
+		const ast_node_var_definition* definition = static_cast<const ast_node_var_definition*>(node);
+		json_key(out, "modifier");
+		json_string(out, modifier_name(definition->modifier));
+		json_key(out, "type");
+		json_string(out, type_name(definition->type));
+		json_key(out, "size");
+		out.number(definition->size);
+		json_key(out, "name");
+		json_string(out, definition->name);
+		json_key(out, "init");
+		json_node(out, definition->init_value);
+		break;
+	}
+	case node_kind::_if: {
+		const ast_node_if* branch = static_cast<const ast_node_if*>(node);
+		json_key(out, "condition");
+		json_node(out, branch->condition_block);
+		json_key(out, "then");
+		json_node(out, branch->true_block);
+		json_key(out, "else");
+		json_node(out, branch->false_block);
+		break;
+	}
+	case node_kind::_while: {
+		const ast_node_while* loop = static_cast<const ast_node_while*>(node);
+		json_key(out, "condition");
+		json_node(out, loop->condition);
+		json_key(out, "body");
+		json_node(out, loop->block);
+		break;
+	}
+	case node_kind::do_while: {
+		const ast_node_do_while* loop = static_cast<const ast_node_do_while*>(node);
+		json_key(out, "condition");
+		json_node(out, loop->condition);
+		json_key(out, "body");
+		json_node(out, loop->block);
+		break;
+	}
+	case node_kind::initial_list:
+		json_nodes(out, "values", static_cast<const ast_node_initial_list*>(node)->values);
+		break;
+	case node_kind::_class: {
+		const ast_node_class* klass = static_cast<const ast_node_class*>(node);
+		json_key(out, "name");
+		json_string(out, klass->name.raw);
+		json_key(out, "body");
+		json_node(out, klass->block);
+		break;
+	}
+	case node_kind::program:
+		json_nodes(out, "body", static_cast<const ast_node_program*>(node)->exprs);
+		break;
+	default:
+		break;
+	}
+	out.put('}');
+}
+
+void ast_dump::binary_u8(sink& out, unsigned char value) {
+	out.put(static_cast<char>(value));
+}
+
+void ast_dump::binary_u32(sink& out, uint32_t value) {
+	out.put(&value, sizeof(value));
+}
+
+void ast_dump::binary_string(sink& out, std::string_view text) {
+	binary_u32(out, static_cast<uint32_t>(text.size()));
+	out.put(text);
+}
+
+void ast_dump::binary_nodes(sink& out, const std::vector<ast_node_base*>& nodes) {
+	binary_u32(out, static_cast<uint32_t>(nodes.size()));
+	for (const ast_node_base* node : nodes) {
+		binary_node(out, node);
+	}
+}
+
+void ast_dump::binary_node(sink& out, const ast_node_base* node) {
+	if (!node) {
+		binary_u8(out, null_node);
+		return;
+	}
+	binary_u8(out, static_cast<unsigned char>(node->kind));
+	binary_u32(out, node->point.line);
+	binary_u32(out, node->point.col);
+	switch (node->kind) {
+	case node_kind::error:
+		binary_string(out, static_cast<const ast_node_error*>(node)->text);
+		break;
+	case node_kind::string:
+		binary_string(out, static_cast<const ast_node_string*>(node)->value.raw);
+		break;
+	case node_kind::value:
+		binary_u8(out, static_cast<unsigned char>(static_cast<const ast_node_value*>(node)->value.type));
+		binary_string(out, static_cast<const ast_node_value*>(node)->value.raw);
+		break;
+	case node_kind::call_function: {
+		const ast_node_call_function* call = static_cast<const ast_node_call_function*>(node);
+		binary_string(out, call->function_name);
+		binary_nodes(out, call->arguments);
+		break;
+	}
+	case node_kind::bin: {
+		const ast_node_bin* bin = static_cast<const ast_node_bin*>(node);
+		binary_u8(out, static_cast<unsigned char>(bin->op));
+		binary_node(out, bin->lhs);
+		binary_node(out, bin->rhs);
+		break;
+	}
+	case node_kind::expr:
+		binary_node(out, static_cast<const ast_node_expr*>(node)->expr);
+		break;
+	case node_kind::_return:
+		binary_node(out, static_cast<const ast_node_return*>(node)->value);
+		break;
+	case node_kind::block: {
+		const ast_node_block* block = static_cast<const ast_node_block*>(node);
+		binary_string(out, block->block_name);
+		binary_nodes(out, block->exprs);
+		break;
+	}
+	case node_kind::function: {
+		const ast_node_function* func = static_cast<const ast_node_function*>(node);
+		binary_string(out, func->function_name);
+		binary_u8(out, static_cast<unsigned char>(func->return_type));
+		binary_u32(out, static_cast<uint32_t>(func->return_type_size));
+		binary_u32(out, static_cast<uint32_t>(func->arguments.size()));
+		for (const context::var_info& arg : func->arguments) {
+			binary_u8(out, static_cast<unsigned char>(arg.modifier));
+			binary_u8(out, static_cast<unsigned char>(arg.type));
+			binary_string(out, arg.name);
+		}
+		binary_node(out, func->block);
+		binary_u8(out, !func->block && func->lazy);
+		break;
+	}
+	case node_kind::repeat: {
+		const ast_node_repeat* repeat = static_cast<const ast_node_repeat*>(node);
+		binary_node(out, repeat->bgn);
+		binary_node(out, repeat->end);
+		break;
+	}
+	case node_kind::array_reference: {
+		const ast_node_array_refernce* reference = static_cast<const ast_node_array_refernce*>(node);
+		binary_string(out, reference->name.raw);
+		binary_node(out, reference->index);
+		break;
+	}
+	case node_kind::var_definition: {
+		const ast_node_var_definition* definition = static_cast<const ast_node_var_definition*>(node);
+		binary_u8(out, static_cast<unsigned char>(definition->modifier));
+		binary_u8(out, static_cast<unsigned char>(definition->type));
+		binary_u32(out, static_cast<uint32_t>(definition->size));
+		binary_string(out, definition->name);
+		binary_node(out, definition->init_value);
+		break;
+	}
+	case node_kind::_if: {
+		const ast_node_if* branch = static_cast<const ast_node_if*>(node);
+		binary_node(out, branch->condition_block);
+		binary_node(out, branch->true_block);
+		binary_node(out, branch->false_block);
+		break;
+	}
+	case node_kind::_while: {
+		const ast_node_while* loop = static_cast<const ast_node_while*>(node);
+		binary_node(out, loop->condition);
+		binary_node(out, loop->block);
+		break;
+	}
+	case node_kind::do_while: {
+		const ast_node_do_while* loop = static_cast<const ast_node_do_while*>(node);
+		binary_node(out, loop->condition);
+		binary_node(out, loop->block);
+		break;
+	}
+	case node_kind::initial_list:
+		binary_nodes(out, static_cast<const ast_node_initial_list*>(node)->values);
+		break;
+	case node_kind::_class: {
+		const ast_node_class* klass = static_cast<const ast_node_class*>(node);
+		binary_string(out, klass->name.raw);
+		binary_node(out, klass->block);
+		break;
+	}
+	case node_kind::program:
+		binary_nodes(out, static_cast<const ast_node_program*>(node)->exprs);
+		break;
+	default:
+		break;
+	}
+}
+
+bool ast_dump::parse_format(std::string_view name, format& style) {
+	if (name == "xml") {
+		style = format::xml;
+	} else if (name == "json") {
+		style = format::json;
+	} else if (name == "binary") {
+		style = format::binary;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+void ast_dump::write(std::ostream& out, const ast_node_base* root, format style) {
+	sink buffered(out);
+	switch (style) {
+	case format::xml:
+		xml_node(buffered, root, 0);
+		break;
+	case format::json:
+		json_node(buffered, root);
+		buffered.put('\n');
+		break;
+	case format::binary:
+		buffered.put(magic, sizeof(magic));
+		binary_u32(buffered, version);
+		binary_node(buffered, root);
+		break;
+	}
+}
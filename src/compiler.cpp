@@ -0,0 +1,289 @@
+#include "compiler.hpp"
+
+
+int compiler::emit(state& st, opcode op, int operand, code_point point) {
+	st.program.code.push_back(instruction { .op = op, .operand = operand });
+	st.program.points.push_back(point);
+	return static_cast<int>(st.program.code.size()) - 1;
+}
+
+int compiler::add_reference(state& st, std::string_view name, int depth, int slot) {
+	st.program.references.push_back(bytecode::variable_reference { .name = std::string(name), .depth = depth, .slot = slot });
+	return static_cast<int>(st.program.references.size()) - 1;
+}
+
+int compiler::add_constant(state& st, OBJECT value) {
+	st.program.constants.push_back(std::move(value));
+	return static_cast<int>(st.program.constants.size()) - 1;
+}
+
+int compiler::add_message(state& st, const std::string& message) {
+	st.program.messages.push_back(message);
+	return static_cast<int>(st.program.messages.size()) - 1;
+}
+
+void compiler::patch(state& st, int at, int target) {
+	st.program.code[at].operand = target;
+}
+
+void compiler::compile_value(state& st, ast_node_base* node) {
+	if (!node) {
+		emit(st, opcode::error, add_message(st, "syntax error(expected expression)"), code_point { 0, 0 });
+		return;
+	}
+	if (is_a<ast_node_value>(node)) {
+		ast_node_value* value = static_cast<ast_node_value*>(node);
+		if (value->value.type != lexer::token_type::identifier) {
+			emit(st, opcode::push_const, add_constant(st, value->constant), value->point);
+		} else if (value->slot < 0) {
+			emit(st, opcode::error, add_message(st, "undefined method(" + std::string(value->value.raw) + ")"), value->value.point);
+		} else {
+			emit(st, opcode::load_var, add_reference(st, value->value.raw, value->depth, value->slot), value->value.point);
+		}
+	} else if (is_a<ast_node_string>(node)) {
+		ast_node_string* value = static_cast<ast_node_string*>(node);
+		emit(st, opcode::push_const, add_constant(st, value->constant), value->point);
+	} else if (is_a<ast_node_call_function>(node)) {
+		ast_node_call_function* call = static_cast<ast_node_call_function*>(node);
+		std::map<std::string, int>::const_iterator itr = st.program.function_index.find(call->function_name);
+		if (itr == st.program.function_index.end()) {
+			emit(st, opcode::error, add_message(st, "not found method(" + call->function_name + ")"), call->point);
+			return;
+		}
+		const context::func_info* info = st.program.functions[itr->second].info;
+		if (!info->block) {
+			emit(st, opcode::error, add_message(st, "not found implement (" + call->function_name + ")"), call->point);
+			return;
+		}
+		if (info->arguments.size() != call->arguments.size()) {
+			emit(st, opcode::error, add_message(st, "the count of arguments is mismatch (" + call->function_name + ")"), call->point);
+			return;
+		}
+		for (ast_node_base* arg : call->arguments) {
+			compile_value(st, arg);
+		}
+		emit(st, opcode::call, itr->second, call->point);
+	} else if (is_a<ast_node_bin>(node)) {
+		ast_node_bin* bin = static_cast<ast_node_bin*>(node);
+		if (bin->op == ast_node_bin::op_type::assign) {
+			compile_assign(st, bin, true);
+			return;
+		}
+		compile_value(st, bin->lhs);
+		compile_value(st, bin->rhs);
+		opcode op = opcode::error;
+		switch (bin->op) {
+		case ast_node_bin::op_type::add: op = opcode::add; break;
+		case ast_node_bin::op_type::sub: op = opcode::sub; break;
+		case ast_node_bin::op_type::mul: op = opcode::mul; break;
+		case ast_node_bin::op_type::div: op = opcode::div; break;
+		case ast_node_bin::op_type::equal: op = opcode::equal; break;
+		case ast_node_bin::op_type::not_equal: op = opcode::not_equal; break;
+		case ast_node_bin::op_type::less_than: op = opcode::less_than; break;
+		case ast_node_bin::op_type::greater_than: op = opcode::greater_than; break;
+		case ast_node_bin::op_type::less_than_or_equal: op = opcode::less_than_or_equal; break;
+		case ast_node_bin::op_type::greater_than_or_equal: op = opcode::greater_than_or_equal; break;
+		default: break;
+		}
+		if (op == opcode::error) {
+			emit(st, opcode::error, add_message(st, "no result"), bin->point);
+			return;
+		}
+		emit(st, op, 0, bin->point);
+	} else if (is_a<ast_node_expr>(node)) {
+		compile_value(st, static_cast<ast_node_expr*>(node)->expr);
+	} else if (is_a<ast_node_repeat>(node)) {
+		ast_node_repeat* repeat = static_cast<ast_node_repeat*>(node);
+		if (!repeat->bgn) {
+			emit(st, opcode::error, add_message(st, "repat expression start value is not found"), repeat->point);
+			return;
+		}
+		if (!repeat->end) {
+			emit(st, opcode::error, add_message(st, "repat expression end value is not found"), repeat->point);
+			return;
+		}
+		compile_value(st, repeat->bgn);
+		compile_value(st, repeat->end);
+		emit(st, opcode::make_range, 0, repeat->point);
+	} else if (is_a<ast_node_array_refernce>(node)) {
+		ast_node_array_refernce* reference = static_cast<ast_node_array_refernce*>(node);
+		if (!reference->index) {
+			emit(st, opcode::error, add_message(st, "not found index"), reference->point);
+			return;
+		}
+		if (reference->slot < 0) {
+			emit(st, opcode::error, add_message(st, "undefined method(" + std::string(reference->name.raw) + ")"), reference->point);
+			return;
+		}
+		compile_value(st, reference->index);
+		emit(st, opcode::load_index, add_reference(st, reference->name.raw, reference->depth, reference->slot), reference->point);
+	} else if (is_a<ast_node_initial_list>(node)) {
+		ast_node_initial_list* list = static_cast<ast_node_initial_list*>(node);
+		int count = 0;
+		for (ast_node_base* ptr : list->values) {
+			if (is_a<ast_node_error>(ptr)) {
+				emit(st, opcode::error, add_message(st, static_cast<ast_node_error*>(ptr)->text), list->point);
+			} else if (is_a<ast_node_value>(ptr) || is_a<ast_node_string>(ptr)) {
+				compile_value(st, ptr);
+				++count;
+			}
+		}
+		emit(st, opcode::make_array, count, list->point);
+	} else if (is_a<ast_node_error>(node)) {
+		ast_node_error* error = static_cast<ast_node_error*>(node);
+		emit(st, opcode::error, add_message(st, "syntax error(" + error->text + ")"), error->point);
+	} else {
+		emit(st, opcode::error, add_message(st, "syntax error(expected expression)"), node->point);
+	}
+}
+
+void compiler::compile_assign(state& st, ast_node_bin* node, bool need_value) {
+	compile_value(st, node->rhs);
+	if (need_value) {
+		emit(st, opcode::dup, 0, node->point);
+	}
+	if (is_a<ast_node_value>(node->lhs)) {
+		ast_node_value* value = static_cast<ast_node_value*>(node->lhs);
+		if (value->value.type != lexer::token_type::identifier) {
+			emit(st, opcode::error, add_message(st, "lhs should be referencer"), value->point);
+			return;
+		}
+		if (value->slot < 0) {
+			emit(st, opcode::error, add_message(st, "not found method(" + std::string(value->value.raw) + ")"), value->point);
+			return;
+		}
+		emit(st, opcode::store_var, add_reference(st, value->value.raw, value->depth, value->slot), value->point);
+	} else if (is_a<ast_node_array_refernce>(node->lhs)) {
+		ast_node_array_refernce* reference = static_cast<ast_node_array_refernce*>(node->lhs);
+		if (reference->slot < 0) {
+			emit(st, opcode::error, add_message(st, "not found method(" + std::string(reference->name.raw) + ")"), reference->point);
+			return;
+		}
+		compile_value(st, reference->index);
+		emit(st, opcode::store_index, add_reference(st, reference->name.raw, reference->depth, reference->slot), reference->point);
+	} else {
+		emit(st, opcode::pop, 0, node->point);
+	}
+}
+
+void compiler::compile_statement(state& st, ast_node_base* node) {
+	if (!node) {
+		return;
+	}
+	if (is_a<ast_node_expr>(node)) {
+		ast_node_base* expr = static_cast<ast_node_expr*>(node)->expr;
+		if (expr && is_a<ast_node_bin>(expr) && static_cast<ast_node_bin*>(expr)->op == ast_node_bin::op_type::assign) {
+			compile_assign(st, static_cast<ast_node_bin*>(expr), false);
+		} else {
+			compile_value(st, expr);
+			emit(st, opcode::pop, 0, node->point);
+		}
+	} else if (is_a<ast_node_return>(node)) {
+		ast_node_return* ret = static_cast<ast_node_return*>(node);
+		if (ret->value) {
+			compile_value(st, ret->value);
+			emit(st, opcode::ret, 1, ret->point);
+		} else {
+			emit(st, opcode::ret, 0, ret->point);
+		}
+	} else if (is_a<ast_node_var_definition>(node)) {
+		compile_var_definition(st, static_cast<ast_node_var_definition*>(node));
+	} else if (is_a<ast_node_if>(node)) {
+		ast_node_if* branch = static_cast<ast_node_if*>(node);
+		compile_value(st, branch->condition_block);
+		int to_false = emit(st, opcode::jump_if_false, 0, branch->point);
+		compile_statement(st, branch->true_block);
+		if (branch->false_block) {
+			int to_end = emit(st, opcode::jump, 0, branch->point);
+			patch(st, to_false, static_cast<int>(st.program.code.size()));
+			compile_statement(st, branch->false_block);
+			patch(st, to_end, static_cast<int>(st.program.code.size()));
+		} else {
+			patch(st, to_false, static_cast<int>(st.program.code.size()));
+		}
+	} else if (is_a<ast_node_while>(node)) {
+		ast_node_while* loop = static_cast<ast_node_while*>(node);
+		int begin = static_cast<int>(st.program.code.size());
+		compile_value(st, loop->condition);
+		int to_end = emit(st, opcode::jump_if_false, 0, loop->point);
+		compile_statement(st, loop->block);
+		emit(st, opcode::jump, begin, loop->point);
+		patch(st, to_end, static_cast<int>(st.program.code.size()));
+	} else if (is_a<ast_node_do_while>(node)) {
+		ast_node_do_while* loop = static_cast<ast_node_do_while*>(node);
+		int begin = static_cast<int>(st.program.code.size());
+		compile_statement(st, loop->block);
+		compile_value(st, loop->condition);
+		emit(st, opcode::jump_if_true, begin, loop->point);
+	} else if (is_a<ast_node_block>(node)) {
+		compile_block(st, static_cast<ast_node_block*>(node));
+	} else if (is_a<ast_node_function>(node) || is_a<ast_node_class>(node)) {
+		return;
+	} else {
+		compile_value(st, node);
+		emit(st, opcode::pop, 0, node->point);
+	}
+}
+
+void compiler::compile_block(state& st, ast_node_block* node) {
+	for (ast_node_base* item : node->exprs) {
+		compile_statement(st, item);
+	}
+}
+
+void compiler::compile_var_definition(state& st, ast_node_var_definition* node) {
+	bytecode::variable_definition definition {
+		.name = node->name,
+		.depth = node->depth,
+		.slot = node->slot,
+		.modifier = node->modifier,
+		.type = node->type,
+		.size = node->size,
+		.has_init = static_cast<bool>(node->init_value),
+		.is_list_init = false,
+		.init_point = node->point
+	};
+	if (node->init_value) {
+		definition.is_list_init = is_a<ast_node_initial_list>(node->init_value) || is_a<ast_node_expr>(node->init_value);
+		definition.init_point = node->init_value->point;
+		compile_value(st, node->init_value);
+	}
+	st.program.definitions.push_back(std::move(definition));
+	emit(st, opcode::define_var, static_cast<int>(st.program.definitions.size()) - 1, node->point);
+}
+
+void compiler::compile_function(state& st, const std::string& name, const context::func_info& info) {
+	int index = st.program.function_index[name];
+	st.program.functions[index].entry = static_cast<int>(st.program.code.size());
+	if (info.block && is_a<ast_node_block>(info.block)) {
+		compile_block(st, static_cast<ast_node_block*>(info.block));
+	} else {
+		compile_statement(st, info.block);
+	}
+	emit(st, opcode::ret, 0, info.block ? info.block->point : code_point { 0, 0 });
+}
+
+bytecode compiler::compile(const context& con, ast_node_base* root) {
+	bytecode program;
+	state st { .program = program, .con = con };
+	for (const std::pair<const std::string, context::func_info>& func : con.func_table) {
+		program.function_index.insert({ func.first, static_cast<int>(program.functions.size()) });
+		program.functions.push_back(bytecode::function_entry { .name = func.first, .entry = -1, .info = &func.second });
+	}
+
+	if (root && is_a<ast_node_program>(root)) {
+		for (ast_node_base* item : static_cast<ast_node_program*>(root)->exprs) {
+			compile_statement(st, item);
+		}
+	} else {
+		compile_statement(st, root);
+	}
+	emit(st, opcode::halt, 0, root ? root->point : code_point { 0, 0 });
+
+	for (const std::pair<const std::string, context::func_info>& func : con.func_table) {
+		if (func.second.block) {
+			compile_function(st, func.first, func.second);
+		}
+	}
+	return program;
+}
@@ -0,0 +1,222 @@
+#include "constant_folder.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+
+bool constant_folder::is_constant(const ast_node_base* node) {
+	if (!node) {
+		return false;
+	}
+	if (is_a<ast_node_value>(node)) {
+		return static_cast<const ast_node_value*>(node)->value.type != lexer::token_type::identifier;
+	}
+	return is_a<ast_node_string>(node);
+}
+
+OBJECT constant_folder::constant_of(const ast_node_base* node) {
+	if (is_a<ast_node_value>(node)) {
+		return static_cast<const ast_node_value*>(node)->constant;
+	}
+	return static_cast<const ast_node_string*>(node)->constant;
+}
+
+ast_node_base* constant_folder::copy_constant(state& st, const ast_node_base* node, code_point point) {
+	if (is_a<ast_node_string>(node)) {
+		return st.arena.make<ast_node_string>(static_cast<const ast_node_string*>(node)->value, point);
+	}
+	const ast_node_value* value = static_cast<const ast_node_value*>(node);
+	ast_node_value* copy = st.arena.make<ast_node_value>(value->value, point);
+	copy->constant = value->constant;
+	return copy;
+}
+
+ast_node_base* constant_folder::make_constant(state& st, const OBJECT& value, code_point point) {
+	lexer::lexeme lexeme { .raw = std::string_view(), .type = lexer::token_type::number, .point = point };
+	switch (value.index()) {
+	case bool_index:
+		lexeme.raw = value.get<bool>() ? "true" : "false";
+		lexeme.type = value.get<bool>() ? lexer::token_type::_true : lexer::token_type::_false;
+		break;
+	case int_index:
+		lexeme.raw = st.arena.copy(std::to_string(value.get<int>()));
+		break;
+	case float_index: {
+		if (!std::isfinite(value.get<float>())) {
+			return nullptr;
+		}
+		char buffer[64];
+		std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer) - 2, value.get<float>(), std::chars_format::fixed);
+		if (result.ec != std::errc()) {
+			return nullptr;
+		}
+		if (!std::memchr(buffer, '.', result.ptr - buffer)) {
+			*result.ptr++ = '.';
+			*result.ptr++ = '0';
+		}
+		lexeme.raw = st.arena.copy(std::string_view(buffer, result.ptr - buffer));
+		if (ast_node_value::decode(lexeme).get<float>() != value.get<float>()) {
+			return nullptr;
+		}
+		break;
+	}
+	case string_index:
+		lexeme.raw = st.arena.copy(value.get<std::string>());
+		lexeme.type = lexer::token_type::string;
+		return st.arena.make<ast_node_string>(lexeme, point);
+	default:
+		return nullptr;
+	}
+	return st.arena.make<ast_node_value>(lexeme, point);
+}
+
+ast_node_base* constant_folder::fold_value(state& st, ast_node_value* node) {
+	if (node->value.type != lexer::token_type::identifier || node->depth != 1 || node->slot < 0 || node->slot >= static_cast<int>(st.constants.size())) {
+		return node;
+	}
+	ast_node_base* constant = st.constants[node->slot];
+	return constant ? copy_constant(st, constant, node->point) : node;
+}
+
+ast_node_base* constant_folder::fold_bin(state& st, ast_node_bin* node) {
+	if (node->op == ast_node_bin::op_type::assign) {
+		if (node->lhs && !is_a<ast_node_value>(node->lhs)) {
+			node->lhs = fold_node(st, node->lhs);
+		}
+		node->rhs = fold_node(st, node->rhs);
+		return node;
+	}
+	node->lhs = fold_node(st, node->lhs);
+	node->rhs = fold_node(st, node->rhs);
+	if (!is_constant(node->lhs) || !is_constant(node->rhs)) {
+		return node;
+	}
+	OBJECT lhs = constant_of(node->lhs);
+	OBJECT rhs = constant_of(node->rhs);
+	if (lhs.index() != rhs.index()) {
+		return node;
+	}
+	OBJECT result = ast_node_bin::operate(node->op, lhs, rhs);
+	if (result.index() == state_index) {
+		return node;
+	}
+	ast_node_base* folded = make_constant(st, result, node->point);
+	return folded ? folded : node;
+}
+
+void constant_folder::fold_var_definition(state& st, ast_node_var_definition* node) {
+	node->init_value = fold_node(st, node->init_value);
+	if (node->depth != 1 || node->slot < 0 || node->slot >= static_cast<int>(st.constants.size())) {
+		return;
+	}
+	ast_node_base* init = node->init_value;
+	if (init && is_a<ast_node_expr>(init)) {
+		init = static_cast<ast_node_expr*>(init)->expr;
+	}
+	bool is_literal = node->modifier == lexer::token_type::_const && node->size < 0 && is_constant(init)
+		&& constant_of(init).index() == static_cast<size_t>(node->type);
+	st.constants[node->slot] = is_literal ? init : nullptr;
+}
+
+ast_node_base* constant_folder::fold_node(state& st, ast_node_base* node) {
+	if (!node) {
+		return node;
+	}
+	switch (node->kind) {
+	case node_kind::value:
+		return fold_value(st, static_cast<ast_node_value*>(node));
+	case node_kind::call_function:
+		for (ast_node_base*& arg : static_cast<ast_node_call_function*>(node)->arguments) {
+			arg = fold_node(st, arg);
+		}
+		break;
+	case node_kind::bin:
+		return fold_bin(st, static_cast<ast_node_bin*>(node));
+	case node_kind::expr: {
+		ast_node_expr* expr = static_cast<ast_node_expr*>(node);
+		expr->expr = fold_node(st, expr->expr);
+		break;
+	}
+	case node_kind::_return: {
+		ast_node_return* ret = static_cast<ast_node_return*>(node);
+		ret->value = fold_node(st, ret->value);
+		break;
+	}
+	case node_kind::block:
+		for (ast_node_base*& item : static_cast<ast_node_block*>(node)->exprs) {
+			item = fold_node(st, item);
+		}
+		break;
+	case node_kind::repeat: {
+		ast_node_repeat* repeat = static_cast<ast_node_repeat*>(node);
+		repeat->bgn = fold_node(st, repeat->bgn);
+		repeat->end = fold_node(st, repeat->end);
+		break;
+	}
+	case node_kind::array_reference: {
+		ast_node_array_refernce* reference = static_cast<ast_node_array_refernce*>(node);
+		reference->index = fold_node(st, reference->index);
+		break;
+	}
+	case node_kind::var_definition:
+		fold_var_definition(st, static_cast<ast_node_var_definition*>(node));
+		break;
+	case node_kind::_if: {
+		ast_node_if* branch = static_cast<ast_node_if*>(node);
+		branch->condition_block = fold_node(st, branch->condition_block);
+		branch->true_block = fold_node(st, branch->true_block);
+		branch->false_block = fold_node(st, branch->false_block);
+		break;
+	}
+	case node_kind::_while: {
+		ast_node_while* loop = static_cast<ast_node_while*>(node);
+		loop->condition = fold_node(st, loop->condition);
+		loop->block = fold_node(st, loop->block);
+		break;
+	}
+	case node_kind::do_while: {
+		ast_node_do_while* loop = static_cast<ast_node_do_while*>(node);
+		loop->block = fold_node(st, loop->block);
+		loop->condition = fold_node(st, loop->condition);
+		break;
+	}
+	case node_kind::initial_list:
+		for (ast_node_base*& value : static_cast<ast_node_initial_list*>(node)->values) {
+			if (value && is_a<ast_node_value>(value)) {
+				value = fold_value(st, static_cast<ast_node_value*>(value));
+			}
+		}
+		break;
+	case node_kind::program:
+		for (ast_node_base*& item : static_cast<ast_node_program*>(node)->exprs) {
+			item = fold_node(st, item);
+		}
+		break;
+	default:
+		break;
+	}
+	return node;
+}
+
+void constant_folder::fold_function(state& st, ast_node_function* node) {
+	if (!node->block) {
+		return;
+	}
+	st.constants.assign(node->frame_size, nullptr);
+	node->block = fold_node(st, node->block);
+}
+
+void constant_folder::fold(context& con, ast_arena& arena, ast_node_base* root) {
+	state st { .arena = arena, .constants = {} };
+	fold_node(st, root);
+	for (ast_node_base* node : con.pre_evaluate) {
+		if (is_a<ast_node_function>(node)) {
+			fold_function(st, static_cast<ast_node_function*>(node));
+		}
+	}
+}
+
+void constant_folder::fold(context& con, ast_arena& arena, ast_node_function* node) {
+	state st { .arena = arena, .constants = {} };
+	fold_function(st, node);
+}
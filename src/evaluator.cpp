@@ -2,31 +2,15 @@
 #include <iostream>
 
 
-std::string ast_evaluator::encode(const context& con, const std::string& name) {
-	std::string encoded_name;
-	for (const auto& item : con.name_space) {
-		encoded_name += item + ".";
+context::var_info* ast_evaluator::find_var(context& con, int depth, int slot) {
+	if (slot < 0 || (depth && con.frame_base + slot >= con.frame_top)) {
+		return nullptr;
 	}
-	return encoded_name + name;
-}
-
-std::map<std::string, context::var_info>::iterator ast_evaluator::find_var(context& con, const std::string name) {
-	std::string _namespace;
-	std::map<std::string, context::var_info>::iterator itr = con.var_table.find(name);
-	std::map<std::string, context::var_info>::iterator tmp;
-	std::vector<std::string> candiate;
-	for (const std::string& item : con.name_space) {
-		_namespace += item + ".";
-		candiate.push_back(_namespace + name);
+	context::var_info* var = depth ? &con.slots[con.frame_base + slot] : &con.globals[slot];
+	if (var->modifier == lexer::token_type::unknown) {
+		return nullptr;
 	}
-
-	for (int i = candiate.size() - 1; i >= 0; --i) {
-		tmp = con.var_table.find(candiate[i]);
-		if (tmp != con.var_table.end()) {
-			itr = tmp;
-		}
-	}
-	return itr;
+	return var;
 }
 
 std::map<std::string, context::func_info>::iterator ast_evaluator::find_func(context& con, const std::string name) {
@@ -50,38 +34,26 @@ std::optional<invalid_state> ast_node_error::evaluate(context& con) {
 }
 
 std::optional<invalid_state> ast_node_string::evaluate(context& con) {
-	con.stack.push_back(value.raw);
+	con.stack.push_back(constant);
 	con.return_code = std::nullopt;
 	return con.return_code;
 }
 
 std::optional<invalid_state> ast_node_value::evaluate(context& con) {
 	if (value.type == lexer::token_type::identifier) {
-		std::map<std::string, context::var_info>::const_iterator itr = find_var(con, value.raw);
-		if (itr == con.var_table.end()) {
+		context::var_info* var = find_var(con, depth, slot);
+		if (!var) {
 			std::cout << "runtime error (" << value.point.line << ", " << value.point.col << "): undefined method(" << value.raw << ")" << std::endl;
 			con.abort();
 		}
-		con.stack.push_back(itr->second.value);
-		return std::visit(get_object_return_code{}, itr->second.value);
-	} else {
-		if (value.type == lexer::token_type::_true) {
-			con.stack.push_back(true);
-			con.return_code = std::nullopt;
-			return con.return_code;
-		} else if (value.type == lexer::token_type::_false) {
-			con.stack.push_back(false);
-			con.return_code = std::nullopt;
-			return con.return_code;
+		con.stack.push_back(var->value);
+		if (typed) {
+			return std::nullopt;
 		}
-		if (value.raw.find('.') != std::string::npos) {
-			con.stack.push_back(static_cast<float>(std::stod(value.raw.c_str())));
-		} else {
-			con.stack.push_back(std::atoi(value.raw.c_str()));
-		}
-		con.return_code = std::nullopt;
-		return con.return_code;
+		return visit_object(get_object_return_code{}, var->value);
 	}
+	con.stack.push_back(constant);
+	con.return_code = std::nullopt;
 	return con.return_code;
 }
 
@@ -91,7 +63,7 @@ std::optional<invalid_state> ast_node_call_function::evaluate(context& con) {
 		std::cout << "runtime error (" << point.line << ", " << point.col << "): not found method(" << function_name << ")" << std::endl;
 		con.abort();
 	}
-	if (!(itr->second.block)) {
+	if (!(itr->second.block) && !parser::parse_body(con, itr->second)) {
 		std::cout << "runtime error (" << point.line << ", " << point.col << "): not found implement (" << function_name << ")" << std::endl;
 		con.abort();
 	}
@@ -101,51 +73,57 @@ std::optional<invalid_state> ast_node_call_function::evaluate(context& con) {
 		con.abort();
 	}
 
+	if (!con.stack.has_headroom()) {
+		std::cout << "runtime error (" << point.line << ", " << point.col << "): stack overflow (" << function_name << ")" << std::endl;
+		con.abort();
+	}
+	size_t bottom = con.reserve_frame(itr->second.frame_size);
 	int idx = 0;
 	for (const context::func_info::arg_info& info: itr->second.arguments) {
 		con.return_code = arguments[idx]->evaluate(con);
 		++idx;
 		OBJECT value = con.stack.back();
 		con.stack.pop_back();
-		if (value.index() != static_cast<int>(info.type)) {
-			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected `" << type_names[static_cast<int>(info.type)] << "` actual `" << std::visit(get_object_type_name{}, value) << "` at index: " << idx << std::endl;
+		if (!typed && value.index() != static_cast<int>(info.type)) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected `" << type_names[static_cast<int>(info.type)] << "` actual `" << visit_object(get_object_type_name{}, value) << "` at index: " << idx << std::endl;
 			con.abort();
 		}
 
-		con.var_table.insert({ encode(con, function_name) + "." + info.name, context::var_info {.modifier = info.modifier, .type = info.type, .value = value}});
+		con.slots[bottom + idx - 1] = context::var_info { .modifier = info.modifier, .type = info.type, .value = std::move(value) };
 	}
+	size_t caller = con.enter_frame(bottom);
 	con.return_code = itr->second.block->evaluate(con);
 	con.is_abort = false;
 
-	if (itr->second.return_type == context::var_type::_bool && con.stack.back().index() != bool_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): expected bool value as return value (type: `" << std::visit(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
-		con.abort();
-	} else if (itr->second.return_type == context::var_type::_int && con.stack.back().index() != int_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): expected int value as return value (type: `" << std::visit(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
-		con.abort();
-	} else if (itr->second.return_type == context::var_type::_float && con.stack.back().index() != float_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): expected float value as return value (type: `" << std::visit(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
-		con.abort();
-	} else if (itr->second.return_type == context::var_type::_str && con.stack.back().index() != string_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): expected str value as return value (type: `" << std::visit(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
-		con.abort();
-	} else if (itr->second.return_type == context::var_type::_bool_array && con.stack.back().index() != bool_array_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): expected bool[] value as return value (type: `" << std::visit(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
-		con.abort();
-	} else if (itr->second.return_type == context::var_type::_int_array && con.stack.back().index() != int_array_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): expected int[] value as return value (type: `" << std::visit(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
-		con.abort();
-	} else if (itr->second.return_type == context::var_type::_float_array && con.stack.back().index() != float_array_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): expected float[] value as return value (type: `" << std::visit(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
-		con.abort();
-	} else if (itr->second.return_type == context::var_type::_str_array && con.stack.back().index() != string_array_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): expected str[] value as return value (type: `" << std::visit(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
-		con.abort();
+	if (!itr->second.function || !itr->second.function->typed) {
+		if (itr->second.return_type == context::var_type::_bool && con.stack.back().index() != bool_index) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected bool value as return value (type: `" << visit_object(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
+			con.abort();
+		} else if (itr->second.return_type == context::var_type::_int && con.stack.back().index() != int_index) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected int value as return value (type: `" << visit_object(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
+			con.abort();
+		} else if (itr->second.return_type == context::var_type::_float && con.stack.back().index() != float_index) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected float value as return value (type: `" << visit_object(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
+			con.abort();
+		} else if (itr->second.return_type == context::var_type::_str && con.stack.back().index() != string_index) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected str value as return value (type: `" << visit_object(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
+			con.abort();
+		} else if (itr->second.return_type == context::var_type::_bool_array && con.stack.back().index() != bool_array_index) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected bool[] value as return value (type: `" << visit_object(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
+			con.abort();
+		} else if (itr->second.return_type == context::var_type::_int_array && con.stack.back().index() != int_array_index) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected int[] value as return value (type: `" << visit_object(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
+			con.abort();
+		} else if (itr->second.return_type == context::var_type::_float_array && con.stack.back().index() != float_array_index) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected float[] value as return value (type: `" << visit_object(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
+			con.abort();
+		} else if (itr->second.return_type == context::var_type::_str_array && con.stack.back().index() != string_array_index) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): expected str[] value as return value (type: `" << visit_object(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
+			con.abort();
+		}
 	}
 
-	for (const context::func_info::arg_info& info : itr->second.arguments) {
-		con.var_table.erase(encode(con, function_name) + "." + info.name);
-	}
+	con.leave_frame(caller);
 	return con.return_code;
 }
 
@@ -163,14 +141,14 @@ std::optional<invalid_state> ast_node_repeat::evaluate(context& con) {
 	OBJECT end_value = con.stack.back(); con.stack.pop_back();
 	OBJECT bgn_value = con.stack.back(); con.stack.pop_back();
 
-	OBJECT list = std::visit(operate_repeat_object {}, bgn_value, end_value);
+	OBJECT list = visit_object(operate_repeat_object {}, bgn_value, end_value);
 	if (list.index() == state_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): " << std::get<invalid_state>(list).message << std::endl;
+		std::cout << "runtime error (" << point.line << ", " << point.col << "): " << list.get<invalid_state>().message << std::endl;
 		con.abort();
 	}
 
 	con.stack.push_back(std::move(list));
-	con.return_code = std::visit(get_object_return_code {}, con.stack.back());
+	con.return_code = visit_object(get_object_return_code {}, con.stack.back());
 	return con.return_code;
 }
 
@@ -182,87 +160,175 @@ std::optional<invalid_state> ast_node_array_refernce::evaluate(context& con) {
 	con.return_code = index->evaluate(con);
 	OBJECT obj_index = con.stack.back();
 	con.stack.pop_back();
-	if (obj_index.index() != int_index) {
+	if (!typed && obj_index.index() != int_index) {
 		std::cout << "runtime error (" << point.line << ", " << point.col << "): index is invalid" << std::endl;
 		con.abort();
 	}
-	std::map<std::string, context::var_info>::iterator itr = find_var(con, name.raw);
-	if (itr == con.var_table.end()) {
+	context::var_info* var = find_var(con, depth, slot);
+	if (!var) {
 		std::cout << "runtime error (" << point.line << ", " << point.col << "): undefined method(" << name.raw << ")" << std::endl;
 		con.abort();
 	}
 
-	OBJECT value = std::visit(operate_index_ref_object(std::get<int>(obj_index)), itr->second.value);
+	OBJECT value = visit_object(operate_index_ref_object(obj_index.get<int>()), var->value);
 	if (value.index() == state_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): " << std::get<invalid_state>(value).message << std::endl;
+		std::cout << "runtime error (" << point.line << ", " << point.col << "): " << value.get<invalid_state>().message << std::endl;
 		con.abort();
 	}
 	con.stack.push_back(std::move(value));
 	return con.return_code;
 }
 
+template <class T>
+static OBJECT operate_typed(ast_node_bin::op_type op, const T& lhs, const T& rhs) {
+	switch (op) {
+	case ast_node_bin::op_type::add:
+		return lhs + rhs;
+	case ast_node_bin::op_type::equal:
+		return lhs == rhs;
+	case ast_node_bin::op_type::not_equal:
+		return lhs != rhs;
+	case ast_node_bin::op_type::less_than:
+		return lhs < rhs;
+	case ast_node_bin::op_type::greater_than:
+		return lhs > rhs;
+	case ast_node_bin::op_type::less_than_or_equal:
+		return lhs <= rhs;
+	case ast_node_bin::op_type::greater_than_or_equal:
+		return lhs >= rhs;
+	default:
+		break;
+	}
+	if constexpr (std::is_arithmetic_v<T>) {
+		switch (op) {
+		case ast_node_bin::op_type::sub:
+			return lhs - rhs;
+		case ast_node_bin::op_type::mul:
+			return lhs * rhs;
+		case ast_node_bin::op_type::div:
+			if (!rhs) {
+				return invalid_state {};
+			}
+			return lhs / rhs;
+		default:
+			break;
+		}
+	}
+	return invalid_state("no result");
+}
+
+OBJECT ast_node_bin::operate(op_type op, OBJECT& lhs, OBJECT& rhs) {
+	switch (op) {
+	case op_type::add:
+		return visit_object(operate_add_object(-1, -1), lhs, rhs);
+	case op_type::sub:
+		return visit_object(operate_sub_object(-1, -1), lhs, rhs);
+	case op_type::mul:
+		return visit_object(operate_mul_object(-1, -1), lhs, rhs);
+	case op_type::div:
+		return visit_object(operate_div_object(-1, -1), lhs, rhs);
+	case op_type::equal:
+		return visit_object(operate_equal_object(-1, -1), lhs, rhs);
+	case op_type::not_equal:
+		return visit_object(operate_not_object(-1, -1), lhs, rhs);
+	case op_type::less_than:
+		return visit_object(operate_less_than_object(-1, -1), lhs, rhs);
+	case op_type::greater_than:
+		return visit_object(operate_greater_than_object(-1, -1), lhs, rhs);
+	case op_type::less_than_or_equal:
+		return visit_object(operate_less_than_or_equal_object(-1, -1), lhs, rhs);
+	case op_type::greater_than_or_equal:
+		return visit_object(operate_greater_than_or_equal_object(-1, -1), lhs, rhs);
+	default:
+		return invalid_state("no result");
+	}
+}
+
 std::optional<invalid_state> ast_node_bin::evaluate(context& con) {
 	con.return_code = lhs->evaluate(con);
 	con.return_code = rhs->evaluate(con);
+	if (typed && op != op_type::assign) {
+		OBJECT& lhs_value = con.stack[con.stack.size() - 2];
+		OBJECT& rhs_value = con.stack.back();
+		OBJECT result;
+		if (operand_type == context::var_type::_int) {
+			result = operate_typed(op, lhs_value.get<int>(), rhs_value.get<int>());
+		} else if (operand_type == context::var_type::_float) {
+			result = operate_typed(op, lhs_value.get<float>(), rhs_value.get<float>());
+		} else {
+			result = operate_typed(op, lhs_value.get<std::string>(), rhs_value.get<std::string>());
+		}
+		if (result.index() == state_index) {
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): divide by zero" << std::endl;
+			con.abort();
+		}
+		con.stack.pop_back();
+		con.stack.back() = std::move(result);
+		con.return_code = std::nullopt;
+		return con.return_code;
+	}
 	OBJECT rhs_value = con.stack.back(); con.stack.pop_back();
 	OBJECT lhs_value = con.stack.back(); con.stack.pop_back();
 
-	if (op == "=") {
-		if (is_a<ast_node_value>(lhs.get())) {
-			ast_node_value* value = static_cast<ast_node_value*>(lhs.get());
+	if (op == op_type::assign) {
+		if (is_a<ast_node_value>(lhs)) {
+			ast_node_value* value = static_cast<ast_node_value*>(lhs);
 			if (value->value.type != lexer::token_type::identifier) {
 				std::cout << "runtime error (" << value->point.line << ", " << value->point.col << "): lhs should be referencer" << std::endl;
 				con.abort();
 			}
-			std::map<std::string, context::var_info>::iterator itr = find_var(con, value->value.raw);
-			if (itr == con.var_table.end()) {
+			context::var_info* var = find_var(con, value->depth, value->slot);
+			if (!var) {
 				std::cout << "runtime error (" << value->point.line << ", " << value->point.col << "): not found method(" << value->value.raw << ")" << std::endl;
 				con.abort();
 			}
-			if (itr->second.modifier == lexer::token_type::_const) {
+			if (var->modifier == lexer::token_type::_const) {
 				std::cout << "runtime error (" << value->point.line << ", " << value->point.col << "): not constant value(" << value->value.raw << ")" << std::endl;
 				con.abort();
 			}
-			if (itr->second.value.index() != rhs_value.index()) {
-				std::cout << "runtime error (" << value->point.line << ", " << value->point.col << "): assign different type(`" << std::visit(get_object_type_name {}, itr->second.value) << "` != `" << std::visit(get_object_type_name {}, rhs_value) << "`)" << std::endl;
+			if (!typed && var->value.index() != rhs_value.index()) {
+				std::cout << "runtime error (" << value->point.line << ", " << value->point.col << "): assign different type(`" << visit_object(get_object_type_name {}, var->value) << "` != `" << visit_object(get_object_type_name {}, rhs_value) << "`)" << std::endl;
 				con.abort();
 			}
-			itr->second.value = std::move(rhs_value);
-		} else if (is_a<ast_node_array_refernce>(lhs.get())) {
-			ast_node_array_refernce* reference = static_cast<ast_node_array_refernce*>(lhs.get());
-			std::map<std::string, context::var_info>::iterator itr = find_var(con, reference->name.raw);
-			if (itr == con.var_table.end()) {
+			var->value = std::move(rhs_value);
+		} else if (is_a<ast_node_array_refernce>(lhs)) {
+			ast_node_array_refernce* reference = static_cast<ast_node_array_refernce*>(lhs);
+			context::var_info* var = find_var(con, reference->depth, reference->slot);
+			if (!var) {
 				std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): not found method(" << reference->name.raw << ")" << std::endl;
 				con.abort();
 			}
-			if (itr->second.modifier == lexer::token_type::_const) {
+			if (var->modifier == lexer::token_type::_const) {
 				std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): not constant value(" << reference->name.raw << ")" << std::endl;
 				con.abort();
 			}
-			if (itr->second.value.index() == float_array_index &&
-				rhs_value.index() != float_index) {
-				std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): assign different type(`float array` != `" << std::visit(get_object_type_name{}, rhs_value) << "`)" << std::endl;
-				con.abort();
-			} else if (itr->second.value.index() == float_array_index &&
-				rhs_value.index() != int_index) {
-				std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): assign different type(`int array" << std::visit(get_object_type_name{}, itr->second.value) << "` != `" << std::visit(get_object_type_name{}, rhs_value) << "`)" << std::endl;
-				con.abort();
-			} else if (itr->second.value.index() == bool_array_index &&
-				rhs_value.index() != bool_index) {
-				std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): assign different type(`bool array" << std::visit(get_object_type_name{}, itr->second.value) << "` != `" << std::visit(get_object_type_name{}, rhs_value) << "`)" << std::endl;
-				con.abort();
+			if (!typed) {
+				if (var->value.index() == float_array_index &&
+					rhs_value.index() != float_index) {
+					std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): assign different type(`float array` != `" << visit_object(get_object_type_name{}, rhs_value) << "`)" << std::endl;
+					con.abort();
+				} else if (var->value.index() == int_array_index &&
+					rhs_value.index() != int_index) {
+					std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): assign different type(`int array" << visit_object(get_object_type_name{}, var->value) << "` != `" << visit_object(get_object_type_name{}, rhs_value) << "`)" << std::endl;
+					con.abort();
+				} else if (var->value.index() == bool_array_index &&
+					rhs_value.index() != bool_index) {
+					std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): assign different type(`bool array" << visit_object(get_object_type_name{}, var->value) << "` != `" << visit_object(get_object_type_name{}, rhs_value) << "`)" << std::endl;
+					con.abort();
+				}
 			}
 			reference->index->evaluate(con);
 			OBJECT index = con.stack.back();
 			con.stack.pop_back();
-			if (index.index() != int_index) {
-				std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): assign different type(`" << std::visit(get_object_type_name{}, itr->second.value) << "` != `" << std::visit(get_object_type_name{}, rhs_value) << "`)" << std::endl;
+			if (!typed && index.index() != int_index) {
+				std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): assign different type(`" << visit_object(get_object_type_name{}, var->value) << "` != `" << visit_object(get_object_type_name{}, rhs_value) << "`)" << std::endl;
 				con.abort();
 			}
 
-			OBJECT result = std::visit(operate_assign_object(std::get<int>(index)), itr->second.value, rhs_value);
+			var->value.detach();
+			OBJECT result = visit_object(operate_assign_object(index.get<int>()), var->value, rhs_value);
 			if (result.index() == state_index) {
-				std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): out of range (" << std::get<int>(index) << ")" << std::endl;
+				std::cout << "runtime error (" << reference->point.line << ", " << reference->point.col << "): out of range (" << index.get<int>() << ")" << std::endl;
 				con.abort();
 			}
 
@@ -271,43 +337,21 @@ std::optional<invalid_state> ast_node_bin::evaluate(context& con) {
 	}
 
 	if (lhs_value.index() != rhs_value.index()) {
-		std::cout << "runtime error (" << lhs->point.line << "," << lhs->point.col << "): assign different type(`" << std::visit(get_object_type_name {}, lhs_value) << "` " << op << " `" << std::visit(get_object_type_name {}, rhs_value) << "`)" << std::endl;
+		std::cout << "runtime error (" << lhs->point.line << "," << lhs->point.col << "): assign different type(`" << visit_object(get_object_type_name {}, lhs_value) << "` " << sign_of(op) << " `" << visit_object(get_object_type_name {}, rhs_value) << "`)" << std::endl;
 		con.abort();
 	} 
 
-	OBJECT result = invalid_state("no result");
-	if (op == "+") {
-		result = std::visit(operate_add_object(-1, -1), lhs_value, rhs_value);
-	} else if (op == "-") {
-		result = std::visit(operate_sub_object(-1, -1), lhs_value, rhs_value);
-	} else if (op == "*") {
-		result = std::visit(operate_mul_object(-1, -1), lhs_value, rhs_value);
-	} else if (op == "/") {
-		result = std::visit(operate_div_object(-1, -1), lhs_value, rhs_value);
-		if (result.index() == state_index) {
-			std::cout << "runtime error (" << point.line << ", " << point.col << "): divide by zero" << std::endl;
-			con.abort();
-		}
-	} else if (op == "==") {
-		result = std::visit(operate_equal_object (-1, -1), lhs_value, rhs_value);
-	} else if (op == "!=") {
-		result = std::visit(operate_not_object (-1, -1), lhs_value, rhs_value);
-	} else if (op == "<") {
-		result = std::visit(operate_less_than_object(-1, -1), lhs_value, rhs_value);
-	} else if (op == ">") {
-		result = std::visit(operate_greater_than_object(-1, -1), lhs_value, rhs_value);
-	} else if (op == "<=") {
-		result = std::visit(operate_less_than_or_equal_object(-1, -1), lhs_value, rhs_value);
-	} else if (op == ">=") {
-		result = std::visit(operate_greater_than_or_equal_object(-1, -1), lhs_value, rhs_value);
+	OBJECT result = operate(op, lhs_value, rhs_value);
+	if (op == op_type::div && result.index() == state_index) {
+		std::cout << "runtime error (" << point.line << ", " << point.col << "): divide by zero" << std::endl;
+		con.abort();
 	}
-
 	if (result.index() == state_index) {
-		std::cout << "runtime error (" << point.line << ", " << point.col << "): " << std::get<invalid_state>(result).message << std::endl;
+		std::cout << "runtime error (" << point.line << ", " << point.col << "): " << result.get<invalid_state>().message << std::endl;
 		con.abort();
 	}
 	con.stack.push_back(std::move(result));
-	con.return_code = std::visit(get_object_return_code {}, result);
+	con.return_code = visit_object(get_object_return_code {}, con.stack.back());
 
 	return con.return_code;
 }
@@ -333,48 +377,57 @@ std::optional<invalid_state> ast_node_function::evaluate(context& con) {
 		info.arguments.push_back(context::func_info::arg_info { .name = arg.name, .modifier = arg.modifier, .type = arg.type });
 	}
 	info.return_type = return_type;
-	info.block = block.get();
+	info.frame_size = frame_size;
+	info.block = block;
+	info.function = this;
 	con.func_table.insert({ function_name, std::move(info) });
 	con.return_code = std::nullopt;
 	return con.return_code;
 }
 std::optional<invalid_state> ast_node_block::evaluate(context& con) {
 	con.name_space.push_back(block_name);
-	for (const std::unique_ptr<ast_node_base>& node : exprs) {
+	size_t height = con.stack.size();
+	for (ast_node_base* node : exprs) {
 		con.return_code = node->evaluate(con);
 		if (con.is_abort) {
 			break;
 		}
+		con.stack.resize(height);
 	}
-	std::map<std::string, context::func_info>::const_iterator itr = con.func_table.find(block_name);
-	if (itr != con.func_table.end()) {
-		if (itr->second.return_type != std::visit(cast_var_type_object {}, con.stack.back())) {
-			std::cout << "runtime error (" << point.line << ", " << point.col << "): assign different type(expected: `" << type_names[static_cast<int>(itr->second.return_type)]
-				<< "`, actual: `" << std::visit(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
-			con.abort();
+	if (!typed || (owner && (!owner->typed || con.stack.size() == height))) {
+		std::map<std::string, context::func_info>::const_iterator itr = con.func_table.find(block_name);
+		if (itr != con.func_table.end()) {
+			if (con.stack.size() == height) {
+				con.stack.push_back(invalid_state());
+			}
+			if (itr->second.return_type != visit_object(cast_var_type_object {}, con.stack.back())) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): assign different type(expected: `" << type_names[static_cast<int>(itr->second.return_type)]
+					<< "`, actual: `" << visit_object(get_object_type_name {}, con.stack.back()) << "`)" << std::endl;
+				con.abort();
+			}
 		}
 	}
 	con.name_space.pop_back();
 	return con.return_code;
 }
 std::optional<invalid_state> ast_node_var_definition::evaluate(context& con) {
-	std::string encoded_name = encode(con, name);
-	if (con.var_table.find(encoded_name) != con.var_table.end()) {
+	if (slot < 0) {
 		std::cout << "runtime error (" << point.line << ", " << point.col << "): variable double definition (" << name << ")" << std::endl;
 		con.abort();
 	}
+	context::var_info& var = depth ? con.slots[con.frame_base + slot] : con.globals[slot];
 	OBJECT value = 0;
 	if (init_value) {
 		con.return_code = init_value->evaluate(con);
 		if (size == 0) {
-			if (!is_a<ast_node_initial_list>(init_value.get()) && !is_a<ast_node_expr>(init_value.get())) {
+			if (!is_a<ast_node_initial_list>(init_value) && !is_a<ast_node_expr>(init_value)) {
 				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): array = `not initialize list`; " << std::endl;
 				con.abort();
 			}
-			con.var_table.insert({ encoded_name, context::var_info { .modifier = modifier, .type = type, .value = con.stack.back() }});
+			var = context::var_info { .modifier = modifier, .type = type, .value = con.stack.back() };
 			con.stack.pop_back();
 		} else if (size > 0) {
-			int init_value_size = std::visit(get_array_size {}, con.stack.back());
+			int init_value_size = visit_object(get_array_size {}, con.stack.back());
 			if (init_value_size < 0) {
 				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): invalid initialize_list" << std::endl;
 				con.abort();
@@ -385,39 +438,44 @@ std::optional<invalid_state> ast_node_var_definition::evaluate(context& con) {
 				con.abort();
 			} if (size > init_value_size) {
 				for (int i = init_value_size; i < size; ++i) {
-					std::visit(insert_to_array(-1), con.stack.back());
+					con.stack.back().detach();
+					visit_object(insert_to_array(-1), con.stack.back());
 				}
 			}
-			if (type == context::var_type::_bool && con.stack.back().index() != bool_index) {
-				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not bool (" << name << ")" << std::endl;
-				con.abort();
-			} else if (type == context::var_type::_int && con.stack.back().index() != int_index) {
-				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not int (" << name << ")" << std::endl;
-				con.abort();
-			} else if (type == context::var_type::_float && con.stack.back().index() != float_index) {
-				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not float (" << name << ")" << std::endl;
-				con.abort();
-			} else if (type == context::var_type::_str && con.stack.back().index() != string_index) {
-				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not str (" << name << ")" << std::endl;
-				con.abort();
+			if (!typed) {
+				if (type == context::var_type::_bool && con.stack.back().index() != bool_index) {
+					std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not bool (" << name << ")" << std::endl;
+					con.abort();
+				} else if (type == context::var_type::_int && con.stack.back().index() != int_index) {
+					std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not int (" << name << ")" << std::endl;
+					con.abort();
+				} else if (type == context::var_type::_float && con.stack.back().index() != float_index) {
+					std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not float (" << name << ")" << std::endl;
+					con.abort();
+				} else if (type == context::var_type::_str && con.stack.back().index() != string_index) {
+					std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not str (" << name << ")" << std::endl;
+					con.abort();
+				}
 			}
-			con.var_table.insert({ encoded_name, context::var_info {.modifier = modifier, .type = type, .value = con.stack.back() } });
+			var = context::var_info { .modifier = modifier, .type = type, .value = con.stack.back() };
 			con.stack.pop_back();
 		} else {
-			if (type == context::var_type::_bool && con.stack.back().index() != bool_index) {
-				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not bool (" << name << ")" << std::endl;
-				con.abort();
-			} else if (type == context::var_type::_int && con.stack.back().index() != int_index) {
-				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not int (" << name << ")" << std::endl;
-				con.abort();
-			} else if (type == context::var_type::_float && con.stack.back().index() != float_index) {
-				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not float (" << name << ")" << std::endl;
-				con.abort();
-			} else if (type == context::var_type::_str && con.stack.back().index() != string_index) {
-				std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not str (" << name << ")" << std::endl;
-				con.abort();
+			if (!typed) {
+				if (type == context::var_type::_bool && con.stack.back().index() != bool_index) {
+					std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not bool (" << name << ")" << std::endl;
+					con.abort();
+				} else if (type == context::var_type::_int && con.stack.back().index() != int_index) {
+					std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not int (" << name << ")" << std::endl;
+					con.abort();
+				} else if (type == context::var_type::_float && con.stack.back().index() != float_index) {
+					std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not float (" << name << ")" << std::endl;
+					con.abort();
+				} else if (type == context::var_type::_str && con.stack.back().index() != string_index) {
+					std::cout << "runtime error (" << init_value->point.line << ", " << init_value->point.col << "): initial value is not str (" << name << ")" << std::endl;
+					con.abort();
+				}
 			}
-			con.var_table.insert({ encoded_name, context::var_info { .modifier = modifier, .type = type, .value = con.stack.back() }});
+			var = context::var_info { .modifier = modifier, .type = type, .value = con.stack.back() };
 			con.stack.pop_back();
 		}
 		return con.return_code;
@@ -456,18 +514,31 @@ std::optional<invalid_state> ast_node_var_definition::evaluate(context& con) {
 		break;
 	}
 	}
-	con.var_table.insert({ encoded_name, context::var_info { .modifier = modifier, .type = type, .value = value }});
+	var = context::var_info { .modifier = modifier, .type = type, .value = value };
 	return con.return_code;
 }
 
-std::optional<invalid_state> ast_node_if::evaluate(context& con) {
-	con.return_code = condition_block->evaluate(con);
-	OBJECT cond = std::visit(cast_bool_object {}, con.stack.back());
+static std::optional<bool> pop_condition(context& con, bool typed) {
+	if (typed) {
+		bool cond = con.stack.back().get<bool>();
+		con.stack.pop_back();
+		return cond;
+	}
+	OBJECT cond = visit_object(cast_bool_object {}, con.stack.back());
 	con.stack.pop_back();
 	if (cond.index() != bool_index) {
+		return std::nullopt;
+	}
+	return cond.get<bool>();
+}
+
+std::optional<invalid_state> ast_node_if::evaluate(context& con) {
+	con.return_code = condition_block->evaluate(con);
+	std::optional<bool> cond = pop_condition(con, typed);
+	if (!cond) {
 		return con.return_code;
 	}
-	if (std::get<bool>(cond)) {
+	if (*cond) {
 		con.return_code = true_block->evaluate(con);
 	} else if (false_block) {
 		con.return_code = false_block->evaluate(con);
@@ -478,12 +549,11 @@ std::optional<invalid_state> ast_node_if::evaluate(context& con) {
 std::optional<invalid_state> ast_node_while::evaluate(context& con) {
 	do {
 		con.return_code = condition->evaluate(con);
-		OBJECT cond = std::visit(cast_bool_object {}, con.stack.back());
-		con.stack.pop_back();
-		if (cond.index() != bool_index) {
+		std::optional<bool> cond = pop_condition(con, typed);
+		if (!cond) {
 			return con.return_code;
 		}
-		if (std::get<bool>(cond)) {
+		if (*cond) {
 			con.return_code = block->evaluate(con);
 		} else {
 			break;
@@ -497,12 +567,11 @@ std::optional<invalid_state> ast_node_do_while::evaluate(context& con) {
 		con.return_code = block->evaluate(con);
 
 		con.return_code = condition->evaluate(con);
-		OBJECT cond = std::visit(cast_bool_object {}, con.stack.back());
-		con.stack.pop_back();
-		if (cond.index() != bool_index) {
+		std::optional<bool> cond = pop_condition(con, typed);
+		if (!cond) {
 			return con.return_code;
 		}
-		if (!std::get<bool>(cond)) {
+		if (!*cond) {
 			break;
 		}
 	} while (true);
@@ -512,25 +581,24 @@ std::optional<invalid_state> ast_node_initial_list::evaluate(context& con) {
 	int type_index = 0;
 	int count = 0;
 	OBJECT object;
-	for (const std::unique_ptr<ast_node_base>& ptr : values) {
-		if (is_a<ast_node_error>(ptr.get())) {
-			ast_node_error* error = static_cast<ast_node_error*>(ptr.get());
+	for (ast_node_base* ptr : values) {
+		if (is_a<ast_node_error>(ptr)) {
+			ast_node_error* error = static_cast<ast_node_error*>(ptr);
 			std::cout << "runtime error (" << point.line << ", " << point.col << "): " << error->text << std::endl;
 			con.return_code = invalid_state("invalid token in the initialize list");
 			con.abort();
-		} else if (is_a<ast_node_value>(ptr.get()) || is_a<ast_node_string>(ptr.get())) {
-			ast_node_value* value = static_cast<ast_node_value*>(ptr.get());
-			con.return_code = value->evaluate(con);
+		} else if (is_a<ast_node_value>(ptr) || is_a<ast_node_string>(ptr)) {
+			con.return_code = ptr->evaluate(con);
 			int current_type = con.stack.back().index();
 			if (!type_index) {
-				object = std::visit(make_array {}, con.stack.back());
+				object = visit_object(make_array {}, con.stack.back());
 				con.stack.pop_back();
 			} else if (type_index != current_type) {
 				std::cout << "runtime error (" << point.line << ", " << point.col << "): different type is found in the initialize list (index: " << count << ")" << std::endl;
 				con.return_code = invalid_state("different type is found in the initialize list");
 				con.abort();
 			} else {
-				std::visit(insert_to_array(-1), object, con.stack.back());
+				visit_object(insert_to_array(-1), object, con.stack.back());
 				con.stack.pop_back();
 			}
 			type_index = current_type;
@@ -546,7 +614,7 @@ std::optional<invalid_state> ast_node_class::evaluate(context& con) {
 }
 
 std::optional<invalid_state> ast_node_program::evaluate(context& con) {
-	for (const std::unique_ptr<ast_node_base>& item : exprs) {
+	for (ast_node_base* item : exprs) {
 		con.return_code = item->evaluate(con);
 		if (con.is_abort) {
 			break;
@@ -554,3 +622,34 @@ std::optional<invalid_state> ast_node_program::evaluate(context& con) {
 	}
 	return con.return_code;
 }
+
+template <class Node>
+static std::optional<invalid_state> evaluate_as(ast_node_base* node, context& con) {
+	return static_cast<Node*>(node)->evaluate(con);
+}
+
+static std::optional<invalid_state> evaluate_base(ast_node_base* node, context& con) {
+	return con.return_code;
+}
+
+const std::array<ast_node_base::evaluator, static_cast<size_t>(node_kind::program) + 1> ast_node_base::evaluators = {
+	evaluate_base,
+	evaluate_as<ast_node_error>,
+	evaluate_as<ast_node_string>,
+	evaluate_as<ast_node_value>,
+	evaluate_as<ast_node_call_function>,
+	evaluate_as<ast_node_bin>,
+	evaluate_as<ast_node_expr>,
+	evaluate_as<ast_node_return>,
+	evaluate_as<ast_node_block>,
+	evaluate_as<ast_node_function>,
+	evaluate_as<ast_node_repeat>,
+	evaluate_as<ast_node_array_refernce>,
+	evaluate_as<ast_node_var_definition>,
+	evaluate_as<ast_node_if>,
+	evaluate_as<ast_node_while>,
+	evaluate_as<ast_node_do_while>,
+	evaluate_as<ast_node_initial_list>,
+	evaluate_as<ast_node_class>,
+	evaluate_as<ast_node_program>,
+};
@@ -1,52 +1,53 @@
 #include "lexer.hpp"
+#include "char_class.hpp"
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <thread>
 
 
 std::optional<lexer::token> lexer::try_parse_number(lexer::context& con) noexcept {
-	std::string tok;
+	if (!char_class::is_digit(*con.itr) && *con.itr != '.') {
+		return std::nullopt;
+	}
+	const char* start = con.itr;
 	bool has_point = false;
-	while (*con.itr) {
-		if (*con.itr >= '0' && *con.itr <= '9') {
-			tok += *con.itr;
-		} else if (!has_point && *con.itr == '.' && *(con.itr + 1) != '.') {
-			tok += *con.itr;
+	for (;;) {
+		con.itr = char_class::skip_digits(con.itr, con.end);
+		if (!has_point && con.itr != con.end && *con.itr == '.' && (con.itr + 1 == con.end || *(con.itr + 1) != '.')) {
 			has_point = true;
+			++con.itr;
+			continue;
 		}
-		else {
-			break;
-		}
-		++con.point.col;
-		++con.itr;
+		break;
 	}
-	return tok.empty() ? std::nullopt : std::optional<token>(token{ .raw = std::move(tok), .type = token_type::number, .point = con.point });
+	return con.itr == start ? std::nullopt : std::optional<token>(make_token(con, start, con.itr, token_type::number));
 }
 
-std::optional<lexer::token> lexer::try_parse_sign_and_keyword(lexer::context& con) noexcept {
-	static keyword_info keywords[] = {
+const lexer::keyword_info* lexer::match_keyword(const char* itr, const char* end, size_t& length) noexcept {
+	static constexpr keyword_info keywords[] = {
 		{ .str = ";", .type = lexer::token_type::semicolon, .is_keyword = false },
-		{ .str = "+", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = "-", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = "*", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = "/", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = "=", .type = lexer::token_type::sign, .is_keyword = false },
+		{ .str = "+", .type = lexer::token_type::plus, .is_keyword = false },
+		{ .str = "-", .type = lexer::token_type::minus, .is_keyword = false },
+		{ .str = "*", .type = lexer::token_type::star, .is_keyword = false },
+		{ .str = "/", .type = lexer::token_type::slash, .is_keyword = false },
+		{ .str = "=", .type = lexer::token_type::assign, .is_keyword = false },
 		{ .str = ":", .type = lexer::token_type::sign, .is_keyword = false },
 		{ .str = ",", .type = lexer::token_type::comma, .is_keyword = false },
 		{ .str = "{", .type = lexer::token_type::sign, .is_keyword = false },
 		{ .str = "}", .type = lexer::token_type::sign, .is_keyword = false },
 		{ .str = "(", .type = lexer::token_type::sign, .is_keyword = false },
 		{ .str = ")", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = "<", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = ">", .type = lexer::token_type::sign, .is_keyword = false },
+		{ .str = "<", .type = lexer::token_type::less_than, .is_keyword = false },
+		{ .str = ">", .type = lexer::token_type::greater_than, .is_keyword = false },
 		{ .str = "[", .type = lexer::token_type::sign, .is_keyword = false },
 		{ .str = "]", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = "<=", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = ">=", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = "!=", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = "==", .type = lexer::token_type::sign, .is_keyword = false },
-		{ .str = "/*", .type = lexer::token_type::comment_begin, .is_keyword = false },
-		{ .str = "*/", .type = lexer::token_type::comment_end, .is_keyword = false },
-		{ .str = "//", .type = lexer::token_type::comment_line, .is_keyword = false },
+		{ .str = "<=", .type = lexer::token_type::less_than_or_equal, .is_keyword = false },
+		{ .str = ">=", .type = lexer::token_type::greater_than_or_equal, .is_keyword = false },
+		{ .str = "!=", .type = lexer::token_type::not_equal, .is_keyword = false },
+		{ .str = "==", .type = lexer::token_type::equal, .is_keyword = false },
 		{ .str = "->", .type = lexer::token_type::arrow, .is_keyword = false },
 		{ .str = "...", .type = lexer::token_type::repeat, .is_keyword = false },
 		{ .str = "return", .type = lexer::token_type::_return, .is_keyword = true },
@@ -65,125 +66,248 @@ std::optional<lexer::token> lexer::try_parse_sign_and_keyword(lexer::context& co
 		{ .str = "do", .type = lexer::token_type::_do, .is_keyword = true },
 		{ .str = "class", .type = lexer::token_type::_class, .is_keyword = true },
 	};
-	if (*con.itr == '\n') {
-		++con.itr;
-		++con.point.line;
-		con.point.col = 0;
-		return token { .raw = "\n", .type = token_type::sign, .point = con.point };
-	}
-	auto start_with = [&con](std::string keyword, std::string::const_iterator _itr) -> int {
-		int i = 0;
-		for (i; keyword[i]; ++i) {
-			if (_itr == con.end ||
-				*_itr != keyword[i]) {
-				return 0;
-			}
-			++_itr;
+	static constexpr size_t trie_capacity = [] {
+		size_t count = 1;
+		for (const keyword_info& keyword : keywords) {
+			count += keyword.str.size();
 		}
-		return i;
-	};
-	int index = -1, max_len = 0, len = 0;
-	for (int i = 0; i < sizeof(keywords) / sizeof(keywords[0]); ++i) {
-		len = start_with(keywords[i].str, con.itr);
-		if (len && max_len < len) {
-			index = i;
-			max_len = len;
-		}
-	}
-	std::string::const_iterator tmp = con.itr;
-	con.itr += max_len;
-	code_point point = con.point;
-	con.point.col += max_len;
-	if (index == -1) {
+		return count;
+	}();
+	static_assert(trie_capacity <= 256);
+	static constexpr keyword_trie<trie_capacity> trie(keywords);
+
+	int index = -1;
+	size_t current = 0;
+	for (const char* _itr = itr; _itr != end; ++_itr) {
+		unsigned char c = static_cast<unsigned char>(*_itr);
+		if (c >= 128 || !trie.nodes[current].next[c]) {
+			break;
+		}
+		current = trie.nodes[current].next[c];
+		if (trie.nodes[current].accept >= 0) {
+			index = trie.nodes[current].accept;
+			length = static_cast<size_t>(_itr - itr) + 1;
+		}
+	}
+	return index == -1 ? nullptr : &keywords[index];
+}
+
+std::optional<lexer::token> lexer::try_parse_sign_and_keyword(lexer::context& con) noexcept {
+	size_t length = 0;
+	const keyword_info* keyword = match_keyword(con.itr, con.end, length);
+	if (!keyword) {
 		return std::nullopt;
 	}
-	if (keywords[index].is_keyword && (isalnum(*con.itr) || *con.itr == '_')) {
-		con.itr = tmp;
-		con.point.col -= max_len;
+	const char* tail = con.itr + length;
+	if (keyword->is_keyword && tail != con.end && char_class::is_identifier(*tail)) {
 		return std::nullopt;
 	}
-	return token { .raw = keywords[index].str, .type = keywords[index].type, .point = point };
+	const char* start = con.itr;
+	con.itr = tail;
+	return make_token(con, start, tail, keyword->type);
 }
 
 std::optional<lexer::token> lexer::try_parse_identifier(lexer::context& con) noexcept {
-	std::string str;
-	if (!isalpha(*con.itr) && *con.itr != '_') {
+	if (!char_class::is_identifier_head(*con.itr)) {
 		return std::nullopt;
 	}
-	str += *con.itr++;
-	++con.point.col;
-	while (con.itr != con.end) {
-		if (isalnum(*con.itr) || *con.itr == '_') {
-			str += *con.itr++;
-			++con.point.col;
-		} else {
-			break;
-		}
+	const char* start = con.itr;
+	con.itr = char_class::skip_identifier(con.itr + 1, con.end);
+	size_t length = 0;
+	const keyword_info* keyword = match_keyword(start, con.itr, length);
+	if (keyword && keyword->is_keyword && length == static_cast<size_t>(con.itr - start)) {
+		return make_token(con, start, con.itr, keyword->type);
 	}
-	if (str == "_") {
-		return token { .raw = str, .type = lexer::token_type::semicolon, .point = con.point };
+	if (con.itr - start == 1 && *start == '_') {
+		return make_token(con, start, con.itr, lexer::token_type::semicolon);
 	}
-	return token { .raw = str, .type = lexer::token_type::identifier, .point = con.point };
+	return make_token(con, start, con.itr, lexer::token_type::identifier);
 }
 
 std::optional<lexer::token> lexer::try_parse_string(context& con) noexcept {
 	if (*con.itr != '\"') {
 		return std::nullopt;
 	}
-	code_point point = con.point;
-	++con.itr;
-	std::string str;
-	while (con.itr != con.end) {
-		if (*con.itr == '\"') {
-			++con.itr;
-			break;
-		}
-		str += *con.itr;
-		++con.itr;
-	}
-	if (con.itr == con.end) {
+	const char* start = con.itr + 1;
+	const char* close = static_cast<const char*>(std::memchr(start, '\"', con.end - start));
+	if (!close) {
 		return std::nullopt;
 	}
-	return token { .raw = str, .type = lexer::token_type::string, .point = point };
+	for (const char* line = start; (line = static_cast<const char*>(std::memchr(line, '\n', close - line))); ++line) {
+		con.line_starts->push_back(static_cast<uint32_t>(line + 1 - con.begin));
+	}
+	con.itr = close + 1;
+	return make_token(con, start, close, lexer::token_type::string);
 }
 
-std::vector<lexer::token> lexer::tokenize(const std::string& source) noexcept {
-	lexer::context con { .point = { .line = 1, .col = 0 }, .itr = source.begin(), .end = source.end() };
-	std::vector<token> toks;
-	while (con.itr != source.end()) {
-		if (std::optional<token> number = try_parse_number(con)) {
-			toks.push_back(number.value());
+const char* lexer::skip_block_comment(const char* itr, const char* end) noexcept {
+	int depth = 1;
+	itr += 2;
+	while (depth) {
+		const char* slash = static_cast<const char*>(std::memchr(itr, '/', end - itr));
+		if (!slash) {
+			return end;
+		}
+		if (slash != itr && *(slash - 1) == '*') {
+			--depth;
+		} else if (slash + 1 != end && *(slash + 1) == '*') {
+			++depth;
+			itr = slash + 2;
 			continue;
 		}
-		if (std::optional<token> keyword = try_parse_sign_and_keyword(con)) {
-			toks.push_back(keyword.value());
+		itr = slash + 1;
+	}
+	return itr;
+}
+
+bool lexer::skip_comment(context& con) noexcept {
+	if (*con.itr != '/' || con.itr + 1 == con.end) {
+		return false;
+	}
+	const char* stop = nullptr;
+	if (*(con.itr + 1) == '/') {
+		stop = static_cast<const char*>(std::memchr(con.itr, '\n', con.end - con.itr));
+		stop = stop ? stop : con.end;
+	} else if (*(con.itr + 1) == '*') {
+		stop = skip_block_comment(con.itr, con.end);
+	} else {
+		return false;
+	}
+	for (const char* line = con.itr; (line = static_cast<const char*>(std::memchr(line, '\n', stop - line))); ++line) {
+		con.line_starts->push_back(static_cast<uint32_t>(line + 1 - con.begin));
+	}
+	con.itr = stop;
+	return true;
+}
+
+bool lexer::skip_whitespace(context& con) noexcept {
+	if (!char_class::is_space(*con.itr)) {
+		return false;
+	}
+	const char* stop = char_class::skip_spaces(con.itr + 1, con.end);
+	for (; con.itr != stop; ++con.itr) {
+		if (*con.itr == '\n') {
+			con.line_starts->push_back(static_cast<uint32_t>(con.itr + 1 - con.begin));
+		}
+	}
+	return true;
+}
+
+lexer::token lexer::make_token(const context& con, const char* start, const char* stop, token_type type) noexcept {
+	if (static_cast<size_t>(stop - con.begin) > UINT32_MAX) {
+		report_error(con, "source is too large");
+	}
+	if (static_cast<size_t>(stop - start) > max_token_length) {
+		report_error(con, "token is too long");
+	}
+	return token { .offset = static_cast<uint32_t>(start - con.begin), .length = static_cast<uint32_t>(stop - start), .type = type };
+}
+
+void lexer::report_error(const context& con, const char* message) noexcept {
+	const char* line_begin = con.begin;
+	unsigned int line = 1;
+	for (const char* itr = con.begin; (itr = static_cast<const char*>(std::memchr(itr, '\n', con.itr - itr))); ++itr) {
+		line_begin = itr + 1;
+		++line;
+	}
+	std::cout << "tokenize error (" << line << ", " << con.itr - line_begin << "): " << message << std::endl;
+	abort();
+}
+
+lexer::token lexer::next(context& con) noexcept {
+	while (con.itr != con.end) {
+		if (skip_whitespace(con) || skip_comment(con)) {
 			continue;
 		}
 		if (std::optional<token> identifier = try_parse_identifier(con)) {
-			toks.push_back(identifier.value());
-			continue;
+			return identifier.value();
+		}
+		if (std::optional<token> number = try_parse_number(con)) {
+			return number.value();
+		}
+		if (std::optional<token> keyword = try_parse_sign_and_keyword(con)) {
+			return keyword.value();
 		}
 		if (std::optional<token> string_tok = try_parse_string(con)) {
-			toks.push_back(string_tok.value());
-			continue;
+			return string_tok.value();
 		}
-		if (std::isspace(*con.itr)) {
-			do {
-				if (*con.itr == '\n') {
-					++con.point.line;
-					con.point.col = 0;
-				} else {
-					++con.point.col;
-				}
-				++con.itr;
-			} while (std::isspace(*con.itr));
-			continue;
+
+		report_error(con, *con.itr == '\"' ? "unterminated string" : "unexpected character");
+	}
+	return make_token(con, con.end, con.end, token_type::eof);
+}
+
+std::vector<const char*> lexer::split_source(std::string_view source, size_t parts) noexcept {
+	const char* itr = source.data();
+	const char* end = source.data() + source.size();
+	std::vector<const char*> bounds { itr };
+	for (size_t i = 1; i < parts && itr != end; ++i) {
+		const char* target = source.data() + source.size() * i / parts;
+		while (itr != end) {
+			if (*itr == '\"') {
+				const char* close = static_cast<const char*>(std::memchr(itr + 1, '\"', end - itr - 1));
+				itr = close ? close + 1 : end;
+			} else if (*itr == '/' && itr + 1 != end && *(itr + 1) == '/') {
+				const char* newline = static_cast<const char*>(std::memchr(itr, '\n', end - itr));
+				itr = newline ? newline : end;
+			} else if (*itr == '/' && itr + 1 != end && *(itr + 1) == '*') {
+				itr = skip_block_comment(itr, end);
+			} else if (*itr++ == '\n' && itr > target) {
+				break;
+			}
+		}
+		if (itr != end) {
+			bounds.push_back(itr);
 		}
+	}
+	bounds.push_back(end);
+	return bounds;
+}
 
-		std::cout << "tokenize error (" << con.point.line << ", " << con.point.col << "):" << *con.itr << std::endl;
-		abort();
+void lexer::tokenize_range(context& con, std::vector<token>& toks) noexcept {
+	toks.reserve((con.end - con.itr) / 4);
+	while (con.itr != con.end) {
+		toks.push_back(next(con));
+		if (toks.back().type == token_type::eof) {
+			toks.pop_back();
+			return;
+		}
 	}
+}
 
-	toks.push_back(token{ .raw = '\0', .type = token_type::eof, .point = con.point });
+std::vector<lexer::token> lexer::tokenize(source_map& map) noexcept {
+	std::string_view source = map.text;
+	size_t parts = std::min<size_t>(std::thread::hardware_concurrency(), source.size() / parallel_chunk);
+	std::vector<const char*> bounds = parts > 1 ? split_source(source, parts) : std::vector<const char*> { source.data(), source.data() + source.size() };
+	size_t count = bounds.size() - 1;
+
+	std::vector<std::vector<uint32_t>> lines(count);
+	std::vector<context> contexts(count);
+	std::vector<std::vector<token>> chunks(count);
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < count; ++i) {
+		contexts[i] = context { .begin = source.data(), .itr = bounds[i], .end = bounds[i + 1], .line_starts = &lines[i] };
+		if (i) {
+			workers.emplace_back(tokenize_range, std::ref(contexts[i]), std::ref(chunks[i]));
+		}
+	}
+	tokenize_range(contexts[0], chunks[0]);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	size_t total = 1;
+	for (const std::vector<token>& chunk : chunks) {
+		total += chunk.size();
+	}
+	std::vector<token> toks = std::move(chunks[0]);
+	toks.reserve(total);
+	for (size_t i = 1; i < count; ++i) {
+		toks.insert(toks.end(), chunks[i].begin(), chunks[i].end());
+	}
+	for (const std::vector<uint32_t>& chunk : lines) {
+		map.line_starts.insert(map.line_starts.end(), chunk.begin(), chunk.end());
+	}
+	toks.push_back(make_token(contexts[count - 1], source.data() + source.size(), source.data() + source.size(), token_type::eof));
 	return toks;
-}
\ No newline at end of file
+}
@@ -1,51 +1,217 @@
 #include <iostream>
-#include <fstream>
+#include <iomanip>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <optional>
 #include "runtime.hpp"
+#include "source_buffer.hpp"
+#include "ast_cache.hpp"
+#include "ast_dump.hpp"
 
 
-int main(int argc, const char* argv[]) {
-	if (argc == 1) {
-		std::cout << "no input" << std::endl;
-		return 1;
+static std::atomic<bool> track_allocations { false };
+static std::atomic<size_t> allocation_count { 0 };
+static std::atomic<size_t> allocation_bytes { 0 };
+
+static void* allocate(std::size_t size) {
+	if (track_allocations.load(std::memory_order_relaxed)) {
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+	if (void* ptr = std::malloc(size ? size : 1)) {
+		return ptr;
 	}
+	throw std::bad_alloc();
+}
 
-	std::ifstream in(argv[1]);
-	std::string source = std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+void* operator new(std::size_t size) {
+	return allocate(size);
+}
+void* operator new[](std::size_t size) {
+	return allocate(size);
+}
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+void operator delete[](void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
 
-	std::cout << "=== source ===" << std::endl;
+class phase_timer {
+public:
+	explicit phase_timer(bool enabled) :
+		enabled(enabled)
+	{
+		track_allocations = enabled;
+	}
 
-	std::cout << source << std::endl;
+	template <class Func>
+	void measure(const char* name, Func&& func) {
+		if (!enabled) {
+			func();
+			return;
+		}
+		size_t count = allocation_count.load();
+		size_t bytes = allocation_bytes.load();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		func();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		phases.push_back({ name, elapsed.count(), allocation_count.load() - count, allocation_bytes.load() - bytes });
+	}
 
-	std::cout << "=== tokens ===" << std::endl;
-	
-	std::vector<lexer::token> toks = lexer::tokenize(source);
-	for (const auto item : toks) {
-		std::cout << item.raw << std::endl;
+	void report() const {
+		if (!enabled) {
+			return;
+		}
+		std::cout << "=== phases ===" << std::endl;
+		std::cout << std::left << std::setw(14) << "phase" << std::right << std::setw(12) << "ms" << std::setw(12) << "allocs" << std::setw(14) << "bytes" << std::endl;
+		for (const phase& item : phases) {
+			std::cout << std::left << std::setw(14) << item.name << std::right << std::fixed << std::setprecision(3) << std::setw(12) << item.milliseconds
+				<< std::setw(12) << item.allocations << std::setw(14) << item.bytes << std::endl;
+		}
 	}
 
-	std::cout << "===   AST  ===" << std::endl;
+private:
+	struct phase {
+		const char* name;
+		double milliseconds;
+		size_t allocations;
+		size_t bytes;
+	};
+	bool enabled;
+	std::vector<phase> phases;
+};
+
+int main(int argc, const char* argv[]) {
+	runtime::engine engine = runtime::engine::tree_walk;
+	const char* path = nullptr;
+	size_t stack_depth = operand_stack::default_depth;
+	bool use_cache = false;
+	bool lazy_bodies = false;
+	bool run = false;
+	bool dump_tokens = false;
+	bool dump_ast = false;
+	bool time_phases = false;
+	ast_dump::format dump_format = ast_dump::format::xml;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "--vm") {
+			engine = runtime::engine::bytecode_vm;
+		} else if (std::string(argv[i]) == "--stack-depth" && i + 1 < argc) {
+			stack_depth = std::stoul(argv[++i]);
+		} else if (std::string(argv[i]) == "--cache") {
+			use_cache = true;
+		} else if (std::string(argv[i]) == "--lazy") {
+			lazy_bodies = true;
+		} else if (std::string(argv[i]) == "--run") {
+			run = true;
+		} else if (std::string(argv[i]) == "--dump-tokens") {
+			dump_tokens = true;
+		} else if (std::string(argv[i]) == "--dump-ast") {
+			dump_ast = true;
+		} else if (std::string(argv[i]) == "--time-phases") {
+			time_phases = true;
+		} else if (std::string(argv[i]) == "--ast-format" && i + 1 < argc) {
+			if (!ast_dump::parse_format(argv[++i], dump_format)) {
+				std::cout << "unknown ast format " << argv[i] << std::endl;
+				return 1;
+			}
+		} else {
+			path = argv[i];
+		}
+	}
+	if (!path) {
+		std::cout << "no input" << std::endl;
+		return 1;
+	}
+	if (!dump_tokens && !dump_ast) {
+		run = true;
+	}
+
+	phase_timer timer(time_phases);
+	std::optional<source_buffer> buffer;
+	timer.measure("read", [&] { buffer.emplace(path); });
+	if (!buffer->good()) {
+		std::cout << "cannot open " << path << std::endl;
+		return 1;
+	}
+	std::string_view source = buffer->view();
+
+	if (dump_tokens || time_phases) {
+		lexer::source_map lines(source);
+		std::vector<lexer::token> toks;
+		if (dump_tokens) {
+			std::cout << "=== tokens ===" << std::endl;
+		}
+		timer.measure("tokenize", [&] { toks = lexer::tokenize(lines); });
+		if (dump_tokens) {
+			for (const lexer::token& item : toks) {
+				std::cout << lines.text_of(item) << '\n';
+			}
+			std::cout.flush();
+		}
+	}
 
 	context con;
-	std::unique_ptr<ast_node_base> root = parser::parse(con, toks);
-	if (root) {
-		std::cout << root->log("") << std::endl;
-	} else {
+	con.stack.set_capacity(stack_depth);
+	con.lazy_bodies = lazy_bodies;
+	ast_tree tree;
+	if (dump_ast) {
+		std::cout << "===   AST  ===" << std::endl;
+	}
+	timer.measure("parse", [&] {
+		if (use_cache) {
+			uint64_t source_hash = ast_cache::hash(source);
+			std::string cache_path = ast_cache::path_for(path, source_hash);
+			tree = ast_cache::load(cache_path, source_hash, source, con);
+			if (!tree.root) {
+				tree = parser::parse(con, source);
+				if (tree.root) {
+					ast_cache::store(cache_path, source_hash, source, tree, con);
+				}
+			}
+		} else {
+			tree = parser::parse(con, source);
+		}
+	});
+	if (!tree.root) {
+		timer.report();
 		return 1;
 	}
+	if (dump_ast) {
+		ast_dump::write(std::cout, tree.root, dump_format);
+		std::cout << std::endl;
+	}
+	if (!run) {
+		timer.report();
+		return 0;
+	}
 
-	std::cout << "==============" << std::endl;
-	runtime::evaluate_pre_process(con);
-	if (con.func_table.find("main") != con.func_table.end()) {
-		con.func_table["main"].block->evaluate(con);
-	} else {
+	if (dump_tokens || dump_ast) {
+		std::cout << "==============" << std::endl;
+	}
+	timer.measure("pre_process", [&] { runtime::evaluate_pre_process(con); });
+	if (con.func_table.find("main") == con.func_table.end()) {
 		std::cout << "not found main()" << std::endl;
+		timer.report();
 		return 2;
 	}
+	timer.measure("execute", [&] { runtime::evaluate_function(tree.root, con, "main", engine); });
 	if (con.stack.size()) {
 		OBJECT return_code = con.stack.back();
-		std::cout << "return code: " << std::visit(get_object_as_string {}, return_code) << std::endl;
+		std::cout << "return code: " << visit_object(get_object_as_string {}, return_code) << std::endl;
 	}
+	std::cout << "peak stack depth: " << con.stack.peak() << " / " << con.stack.capacity() << std::endl;
+	timer.report();
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -1,9 +1,34 @@
 #include "parser.hpp"
+#include "resolver.hpp"
+#include "constant_folder.hpp"
+#include "type_checker.hpp"
 #include <iostream>
 #include <cassert>
+#include <thread>
 
 
-void parser::skip_until_semicolon(std::vector<lexer::token>::const_iterator& itr) {
+const std::array<parser::binary_info, 256> parser::binary_table = [] {
+	using op_type = ast_node_bin::op_type;
+	using token_type = lexer::token_type;
+	std::array<binary_info, 256> table {};
+	auto set = [&table](token_type type, binary_info info) {
+		table[static_cast<unsigned char>(type)] = info;
+	};
+	set(token_type::assign, { .op = op_type::assign, .precedence = 1, .right_associative = true });
+	set(token_type::equal, { .op = op_type::equal, .precedence = 2, .chainable = false, .requires_rhs = true });
+	set(token_type::not_equal, { .op = op_type::not_equal, .precedence = 2, .chainable = false, .requires_rhs = true });
+	set(token_type::less_than, { .op = op_type::less_than, .precedence = 3, .chainable = false, .requires_rhs = true });
+	set(token_type::greater_than, { .op = op_type::greater_than, .precedence = 3, .chainable = false, .requires_rhs = true });
+	set(token_type::less_than_or_equal, { .op = op_type::less_than_or_equal, .precedence = 3, .chainable = false, .requires_rhs = true });
+	set(token_type::greater_than_or_equal, { .op = op_type::greater_than_or_equal, .precedence = 3, .chainable = false, .requires_rhs = true });
+	set(token_type::plus, { .op = op_type::add, .precedence = 4 });
+	set(token_type::minus, { .op = op_type::sub, .precedence = 4 });
+	set(token_type::star, { .op = op_type::mul, .precedence = 5 });
+	set(token_type::slash, { .op = op_type::div, .precedence = 5 });
+	return table;
+}();
+
+void parser::skip_until_semicolon(lexer::stream& itr) {
 	while (itr->type != lexer::token_type::eof) {
 		if (itr->type == lexer::token_type::semicolon) {
 			return;
@@ -12,15 +37,29 @@ void parser::skip_until_semicolon(std::vector<lexer::token>::const_iterator& itr
 	}
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_value(context& con, std::vector<lexer::token>::const_iterator& itr) {
-	if (itr->type == lexer::token_type::identifier && (itr + 1)->raw == "(") {
+void parser::skip_block(lexer::stream& itr) {
+	int depth = 0;
+	while (itr->type != lexer::token_type::eof) {
+		if (itr->raw == "{") {
+			++depth;
+		} else if (itr->raw == "}" && --depth == 0) {
+			++itr;
+			return;
+		}
+		++itr;
+	}
+}
+
+ast_node_base* parser::try_build_value(context& con, lexer::stream& itr) {
+	if (itr->type == lexer::token_type::identifier && itr.peek(1).raw == "(") {
 		return try_build_call_function(con, itr);
 	}
-	if (itr->type == lexer::token_type::identifier && (itr + 1)->raw == "[") {
+	if (itr->type == lexer::token_type::identifier && itr.peek(1).raw == "[") {
 		return try_build_reference_array(con, itr);
 	}
 	if (itr->type == lexer::token_type::string) {
-		return std::make_unique<ast_node_string>(*itr++, itr->point);
+		lexer::lexeme value = itr++;
+		return con.arena->make<ast_node_string>(value, value.point);
 	}
 	if (itr->raw == "{") {
 		return try_build_initial_list(con, itr);
@@ -31,11 +70,12 @@ std::unique_ptr<ast_node_base> parser::try_build_value(context& con, std::vector
 		itr->type != lexer::token_type::identifier) {
 		return nullptr;
 	}
-	return std::make_unique<ast_node_value>(*itr++, itr->point);
+	lexer::lexeme value = itr++;
+	return con.arena->make<ast_node_value>(value, value.point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_repeat(context& con, std::vector<lexer::token>::const_iterator& itr) {
-	std::unique_ptr<ast_node_base> bgn = try_build_value(con, itr);
+ast_node_base* parser::try_build_repeat(context& con, lexer::stream& itr) {
+	ast_node_base* bgn = try_build_value(con, itr);
 	if (!bgn) {
 		return nullptr;
 	}
@@ -43,243 +83,152 @@ std::unique_ptr<ast_node_base> parser::try_build_repeat(context& con, std::vecto
 		return bgn;
 	}
 	++itr;
-	std::unique_ptr<ast_node_base> end = try_build_value(con, itr);
+	ast_node_base* end = try_build_value(con, itr);
 	if (!end) {
-		return std::make_unique<ast_node_error>("expected end value", itr->point);
+		return con.arena->make<ast_node_error>("expected end value", itr->point);
 	}
-	return std::make_unique<ast_node_repeat>(std::move(bgn), std::move(end), itr->point);
+	return con.arena->make<ast_node_repeat>(bgn, end, itr->point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_timedivide_node(context& con, std::vector<lexer::token>::const_iterator& itr) {
-	std::unique_ptr<ast_node_base> lhs = try_build_repeat(con, itr);
-	if (!lhs) {
-		return nullptr;
-	}
-
-	std::unique_ptr<ast_node_bin> node;
-	std::string op;
-	while (lhs) {
-		if (itr->raw == "*" || itr->raw == "/") {
-			node = std::make_unique<ast_node_bin>();
-			node->op = itr->raw[0];
-			node->lhs = std::move(lhs);
-			node->point = itr->point;
-			++itr;
-			node->rhs = try_build_repeat(con, itr);
-			lhs = std::move(node);
-		}
-		else {
-			return lhs;
-		}
-	}
-	assert(false);
-	return nullptr;
-}
-
-std::unique_ptr<ast_node_base> parser::try_build_plusminus_node(context& con, std::vector<lexer::token>::const_iterator& itr) {
-	std::unique_ptr<ast_node_base> lhs = try_build_timedivide_node(con, itr);
-	if (!lhs || is_a<ast_node_error>(lhs.get())) {
+ast_node_base* parser::try_build_binary(context& con, lexer::stream& itr, int min_precedence) {
+	ast_node_base* lhs = try_build_repeat(con, itr);
+	if (!lhs || is_a<ast_node_error>(lhs)) {
 		return lhs;
 	}
 
-	std::unique_ptr<ast_node_bin> node;
-	while (lhs) {
-		if (itr->raw == "+" || itr->raw == "-") {
-			node = std::make_unique<ast_node_bin>();
-			node->op = itr->raw[0];
-			node->lhs = std::move(lhs);
-			node->point = itr->point;
-			++itr;
-			node->rhs = try_build_timedivide_node(con, itr);
-			lhs = std::move(node);
-		}
-		else {
+	int max = max_precedence;
+	for (;;) {
+		const binary_info& info = binary_table[static_cast<unsigned char>(itr->type)];
+		if (info.op == ast_node_bin::op_type::unknown || info.precedence < min_precedence || info.precedence > max) {
 			return lhs;
 		}
-	}
-	assert(false);
-	return nullptr;
-}
-
-std::unique_ptr<ast_node_base> parser::try_build_equality(context& con, std::vector<lexer::token>::const_iterator& itr) {
-	std::unique_ptr<ast_node_base> lhs = try_build_relational(con, itr);
-	if (!lhs) {
-		return nullptr;
-	}
-	if (itr->raw != "==" &&
-		itr->raw != "!=") {
-		return std::move(lhs);
-	}
-	std::unique_ptr<ast_node_bin> node = std::make_unique<ast_node_bin>();
-	node->lhs = std::move(lhs);
-	node->point = itr->point;
-	node->op = itr->raw;
-	++itr;
-	node->rhs = try_build_relational(con, itr);
-	if (!(node->rhs)) {
-		return std::make_unique<ast_node_error>("not found right hand of `"+ node->op + "`", node->point);
-	}
-	return std::move(node);
-}
-
-std::unique_ptr<ast_node_base> parser::try_build_relational(context& con, std::vector<lexer::token>::const_iterator& itr) {
-	std::unique_ptr<ast_node_base> lhs = try_build_plusminus_node(con, itr);
-	if (!lhs) {
-		return nullptr;
-	}
-	if (itr->raw != "<" &&
-		itr->raw != ">" &&
-		itr->raw != "<=" &&
-		itr->raw != ">=") {
-		return lhs;
-	}
-	std::unique_ptr<ast_node_bin> node = std::make_unique<ast_node_bin>();
-	node->lhs = std::move(lhs);
-	node->point = itr->point;
-	node->op = itr->raw;
-	++itr;
-	node->rhs = try_build_plusminus_node(con, itr);
-	if (!(node->rhs)) {
-		return std::make_unique<ast_node_error>("not found right hand of `" + node->op + "`", node->point);
-	}
-	return std::move(node);
-}
-
-std::unique_ptr<ast_node_base> parser::try_build_assign(context& con, std::vector<lexer::token>::const_iterator& itr) {
-	std::unique_ptr<ast_node_base> lhs = try_build_equality(con, itr);
-	if (!lhs) {
-		return nullptr;
-	}
-	std::unique_ptr<ast_node_bin> node = nullptr;
-	while (lhs) {
-		if (itr->raw == "=") {
-			node = std::make_unique<ast_node_bin>();
-			node->op = itr->raw[0];
-			node->lhs = std::move(lhs);
-			node->point = itr->point;
-			++itr;
-			node->rhs = try_build_assign(con, itr);
-			lhs = std::move(node);
-		} else {
-			return lhs;
+		ast_node_bin* node = con.arena->make<ast_node_bin>();
+		node->op = info.op;
+		node->lhs = lhs;
+		node->point = itr->point;
+		++itr;
+		node->rhs = try_build_binary(con, itr, info.right_associative ? info.precedence : info.precedence + 1);
+		if (!node->rhs && info.requires_rhs) {
+			return con.arena->make<ast_node_error>("not found right hand of `" + std::string(ast_node_bin::sign_of(node->op)) + "`", node->point);
+		}
+		if (!info.chainable) {
+			max = info.precedence - 1;
 		}
+		lhs = node;
 	}
-	assert(false);
-	return nullptr;
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_expr(context& con, std::vector<lexer::token>::const_iterator& itr) {
-	std::unique_ptr<ast_node_base> expr = try_build_assign(con, itr);
+ast_node_base* parser::try_build_expr(context& con, lexer::stream& itr) {
+	ast_node_base* expr = try_build_binary(con, itr);
 	if (!expr) {
 		return nullptr;
 	}
 	
 	if (itr->type != lexer::token_type::semicolon) {
-		return std::make_unique<ast_node_error>("not found semicolon", itr->point);
+		return con.arena->make<ast_node_error>("not found semicolon", itr->point);
 	}
 	++itr;
-	return std::make_unique<ast_node_expr>(std::move(expr), expr->point);
+	return con.arena->make<ast_node_expr>(expr, expr->point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_call_function(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_call_function(context& con, lexer::stream& itr) {
 	if (itr->type != lexer::token_type::identifier) {
 		return nullptr;
 	}
-	std::string name = itr->raw;
+	std::string name(itr->raw);
 	code_point point = itr->point;
-	if ((itr + 1)->raw != "(") {
+	if (itr.peek(1).raw != "(") {
 		return nullptr;
 	}
 	++itr;
 	++itr;
 	
-	std::vector<std::unique_ptr<ast_node_base>> arguments;
-	std::unique_ptr<ast_node_base> node;
+	std::vector<ast_node_base*> arguments;
+	ast_node_base* node = nullptr;
 	while (itr->type != lexer::token_type::eof) {
-		node = try_build_assign(con, itr);
+		node = try_build_binary(con, itr);
 		if (!node) {
 			skip_until_semicolon(itr);
-			node = std::make_unique<ast_node_error>("argument is invalid", point);
+			node = con.arena->make<ast_node_error>("argument is invalid", point);
 		}
-		arguments.push_back(std::move(node));
+		arguments.push_back(node);
 		if (itr->raw == ")") {
 			break;
 		}
 		if (itr->type != lexer::token_type::comma) {
 			skip_until_semicolon(itr);
-			return std::make_unique<ast_node_error>("not found `,`", point);
+			return con.arena->make<ast_node_error>("not found `,`", point);
 		}
 		++itr;
 	}
 	if (itr->raw != ")") {
 		skip_until_semicolon(itr);
-		return std::make_unique<ast_node_error>("expected `)`", point);
+		return con.arena->make<ast_node_error>("expected `)`", point);
 	}
 	++itr;
-	return std::make_unique<ast_node_call_function>(name, std::move(arguments), point);
+	return con.arena->make<ast_node_call_function>(name, std::move(arguments), point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_reference_array(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_reference_array(context& con, lexer::stream& itr) {
 	if (itr->type != lexer::token_type::identifier) {
 		return nullptr;
 	}
-	lexer::token name = *itr;
-	std::vector<lexer::token>::const_iterator tmp = itr;
-	++tmp;
-	if (tmp->raw != "[") {
+	lexer::lexeme name = *itr;
+	if (itr.peek(1).raw != "[") {
 		return nullptr;
 	}
-	code_point point = tmp->point;
-	++tmp;
-	std::unique_ptr<ast_node_base> index = try_build_assign(con, tmp);
-	if (tmp->raw != "]") {
-		itr = tmp;
-		return std::make_unique<ast_node_error>("expected `]`", tmp->point);
+	++itr;
+	code_point point = itr->point;
+	++itr;
+	ast_node_base* index = try_build_binary(con, itr);
+	if (itr->raw != "]") {
+		return con.arena->make<ast_node_error>("expected `]`", itr->point);
 	}
-	itr = ++tmp;
-	return std::make_unique<ast_node_array_refernce>(name, std::move(index), point);
+	++itr;
+	return con.arena->make<ast_node_array_refernce>(name, index, point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_return(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_return(context& con, lexer::stream& itr) {
 	if (itr->type != lexer::token_type::_return) {
 		return nullptr;
 	}
 	++itr;
-	std::unique_ptr<ast_node_base> node = try_build_expr(con, itr);
+	ast_node_base* node = try_build_expr(con, itr);
 	if (!node) {
 		skip_until_semicolon(itr);
 		if (itr->type == lexer::token_type::semicolon) {
 			++itr;
 		}
 	}
-	return std::make_unique<ast_node_return>(std::move(node), itr->point);
+	return con.arena->make<ast_node_return>(node, itr->point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_var_definition(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_var_definition(context& con, lexer::stream& itr) {
 	code_point point { 0, 0 };
 	if (itr->type != lexer::token_type::_const &&
 		itr->type != lexer::token_type::_mut) {
 		return nullptr;
 	}
 	lexer::token_type modifier = itr->type;
-	std::vector<lexer::token>::const_iterator tmp = itr + 1;
-	lexer::token var_name_token = *tmp;
-	point = tmp->point;
-	++tmp;
+	code_point modifier_point = itr->point;
+	++itr;
+	lexer::lexeme var_name_token = *itr;
+	point = itr->point;
+	++itr;
 
-	if (tmp->raw != ":") {
-		itr = tmp;
+	if (itr->raw != ":") {
+		code_point error_point = itr->point;
 		std::cout << "expected `:`" << std::endl;
 		skip_until_semicolon(itr);
 		if (itr->type == lexer::token_type::semicolon) {
 			++itr;
 		}
-		return std::make_unique<ast_node_error>("expected identifier", tmp->point);
+		return con.arena->make<ast_node_error>("expected identifier", error_point);
 	}
-	++tmp;
+	++itr;
 
-	lexer::token_type type = tmp->type;
-	switch (tmp->type) {
+	lexer::token_type type = itr->type;
+	switch (itr->type) {
 	case lexer::token_type::_int: break;
 	case lexer::token_type::_float: break;
 	case lexer::token_type::_bool: break;
@@ -287,283 +236,277 @@ std::unique_ptr<ast_node_base> parser::try_build_var_definition(context& con, st
 	case lexer::token_type::identifier: break;
 	default:
 		type = lexer::token_type::unknown;
-		point = itr->point;
+		point = modifier_point;
 		break;
 	}
-	++tmp;
+	++itr;
 	int size = -1;
 	bool is_integer_dim = false;
-	if (tmp->raw == "[") {
+	if (itr->raw == "[") {
 		size = 0;
-		++tmp;
-		if (tmp->type == lexer::token_type::number) {
-			is_integer_dim = tmp->raw.find(".") == std::string::npos;
-			size = std::atoi(tmp->raw.c_str());
-			++tmp;
-		} else if (tmp->raw != "]") {
-			itr = tmp;
-			std::cout << "expected `]`" << tmp->raw << ")" << std::endl;
+		++itr;
+		if (itr->type == lexer::token_type::number) {
+			is_integer_dim = itr->raw.find(".") == std::string::npos;
+			size = std::atoi(std::string(itr->raw).c_str());
+			++itr;
+		} else if (itr->raw != "]") {
+			std::cout << "expected `]`" << itr->raw << ")" << std::endl;
 			skip_until_semicolon(itr);
 			if (itr->type == lexer::token_type::semicolon) {
 				++itr;
 			}
-			return std::make_unique<ast_node_error>("expected `]`", itr->point);
+			return con.arena->make<ast_node_error>("expected `]`", itr->point);
 		} else {
 			is_integer_dim = true;
 		}
-		++tmp;
+		++itr;
 	}
 
-	if (tmp->type == lexer::token_type::semicolon) {
-		itr = ++tmp;
+	if (itr->type == lexer::token_type::semicolon) {
+		++itr;
 		if (type == lexer::token_type::unknown) {
-			return std::make_unique<ast_node_error>("invalid type : " + tmp->raw, point);
+			return con.arena->make<ast_node_error>("invalid type : " + std::string(itr->raw), point);
 		}
 		if (var_name_token.type != lexer::token_type::identifier) {
-			return std::make_unique<ast_node_error>("expected identifier", point);
+			return con.arena->make<ast_node_error>("expected identifier", point);
 		}
 		if (size >= 0 && !is_integer_dim) {
-			return std::make_unique<ast_node_error>("dimension should be integer", point);
+			return con.arena->make<ast_node_error>("dimension should be integer", point);
 		}
 
-		return std::make_unique<ast_node_var_definition>(modifier, var_name_token.raw, context::cast_from_token(type, size >= 0), size, point);
+		return con.arena->make<ast_node_var_definition>(modifier, std::string(var_name_token.raw), context::cast_from_token(type, size >= 0), size, point);
 	}
 
-	if (tmp->raw != "=") {
-		itr = tmp;
+	if (itr->raw != "=") {
 		skip_until_semicolon(itr);
 		if (itr->type == lexer::token_type::semicolon) {
 			++itr;
 		}
-		return std::make_unique<ast_node_error>("expected `=`", itr->point);
+		return con.arena->make<ast_node_error>("expected `=`", itr->point);
 	}
-	point = tmp->point;
-	++tmp;
-	std::unique_ptr<ast_node_base> init_value;
+	point = itr->point;
+	++itr;
+	ast_node_base* init_value = nullptr;
 	if (size < 0) {
-		init_value = try_build_expr(con, tmp);
+		init_value = try_build_expr(con, itr);
 		if (!init_value) {
-			itr = tmp;
 			skip_until_semicolon(itr);
 			if (itr->type == lexer::token_type::semicolon) {
 				++itr;
 			}
-			return std::make_unique<ast_node_error>("initial value is invalid", itr->point);
+			return con.arena->make<ast_node_error>("initial value is invalid", itr->point);
 		}
 	} else {
-		init_value = try_build_initial_list(con, tmp);
+		init_value = try_build_initial_list(con, itr);
 		if (!init_value) {
-			init_value = try_build_expr(con, tmp);
-			if (!init_value && !is_a<ast_node_repeat>(init_value.get())) {
-				itr = tmp;
+			init_value = try_build_expr(con, itr);
+			if (!init_value && !is_a<ast_node_repeat>(init_value)) {
 				skip_until_semicolon(itr);
 				if (itr->type == lexer::token_type::semicolon) {
 					++itr;
 				}
-				return std::make_unique<ast_node_error>("initial value is invalid", itr->point);
+				return con.arena->make<ast_node_error>("initial value is invalid", itr->point);
 			}
 		}
-		if (!is_a<ast_node_expr>(init_value.get()) && tmp->type != lexer::token_type::semicolon) {
-			itr = tmp;
-			return std::make_unique<ast_node_error>("not found semicolon", itr->point);
+		if (!is_a<ast_node_expr>(init_value) && itr->type != lexer::token_type::semicolon) {
+			return con.arena->make<ast_node_error>("not found semicolon", itr->point);
 		}
 		if (!is_integer_dim) {
-			itr = tmp;
-			return std::make_unique<ast_node_error>("dimension should be integer", point);
+			return con.arena->make<ast_node_error>("dimension should be integer", point);
 		}
-		if (is_a<ast_node_initial_list>(init_value.get())) {
-			ast_node_initial_list* values = static_cast<ast_node_initial_list*>(init_value.get());
+		if (is_a<ast_node_initial_list>(init_value)) {
+			ast_node_initial_list* values = static_cast<ast_node_initial_list*>(init_value);
 			if (size == 0) {
 				size = values->values.size();
 			} else if (size < values->values.size()) {
 				std::cout << "the array size < the size of initialize_list (" << size << "<" << values->values.size() << ")" << std::endl;
-				while (tmp->type != lexer::token_type::eof && tmp->raw != "}") {
-					++tmp;
+				while (itr->type != lexer::token_type::eof && itr->raw != "}") {
+					++itr;
 				}
-				itr = tmp;
-				return std::make_unique<ast_node_error>("the array size < the size of initialize_list (" + std::to_string(size) + "<" + std::to_string(values->values.size()) + ")", itr->point);
+				return con.arena->make<ast_node_error>("the array size < the size of initialize_list (" + std::to_string(size) + "<" + std::to_string(values->values.size()) + ")", itr->point);
 			}
 		}
-		++tmp;
+		if (!is_a<ast_node_expr>(init_value)) {
+			++itr;
+		}
 	}
 
-	itr = tmp;
 	if (var_name_token.type != lexer::token_type::identifier) {
-		return std::make_unique<ast_node_error>("expected identifier", point);
+		return con.arena->make<ast_node_error>("expected identifier", point);
 	}
-	return std::make_unique<ast_node_var_definition>(modifier, var_name_token.raw, context::cast_from_token(type, size >= 0), size, std::move(init_value), point);
+	return con.arena->make<ast_node_var_definition>(modifier, std::string(var_name_token.raw), context::cast_from_token(type, size >= 0), size, init_value, point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_initial_list(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_initial_list(context& con, lexer::stream& itr) {
 	if (itr->raw != "{") {
 		return nullptr;
 	}
 	code_point bgn_point = itr->point;
 	++itr;
-	std::vector<std::unique_ptr<ast_node_base>> values;
+	std::vector<ast_node_base*> values;
 	while (itr->raw != "}") {
-		std::unique_ptr<ast_node_base> value = try_build_repeat(con, itr);
+		ast_node_base* value = try_build_repeat(con, itr);
 		if (!value) {
-			values.push_back(std::make_unique<ast_node_error>("invalid token in the initialize_list", itr->point));
+			values.push_back(con.arena->make<ast_node_error>("invalid token in the initialize_list", itr->point));
 		} else {
-			values.push_back(std::move(value));
+			values.push_back(value);
 		}
 		if (itr->raw == "}") {
 			break;
 		}
 		if (itr->raw != ",") {
-			values.push_back(std::make_unique<ast_node_error>("expected `,`", itr->point));
+			values.push_back(con.arena->make<ast_node_error>("expected `,`", itr->point));
 		}
 		++itr;
 		if (itr->type == lexer::token_type::eof) {
-			return std::make_unique<ast_node_error>("expected `}`", bgn_point);
+			return con.arena->make<ast_node_error>("expected `}`", bgn_point);
 		}
 	}
 	++itr;
-	return std::make_unique<ast_node_initial_list>(std::move(values), bgn_point);
+	return con.arena->make<ast_node_initial_list>(std::move(values), bgn_point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_if(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_if(context& con, lexer::stream& itr) {
 	if (itr->type != lexer::token_type::_if) {
 		return nullptr;
 	}
 	++itr;
 	if (itr->raw != "(") {
-		return std::make_unique<ast_node_error>("expected `(`", itr->point);
+		return con.arena->make<ast_node_error>("expected `(`", itr->point);
 	}
 	++itr;
-	std::unique_ptr<ast_node_base> cond = try_build_assign(con, itr);
+	ast_node_base* cond = try_build_binary(con, itr);
 	if (itr->raw != ")") {
-		return std::make_unique<ast_node_error>("expected `)`", itr->point);
+		return con.arena->make<ast_node_error>("expected `)`", itr->point);
 	}
 	++itr;
-	std::unique_ptr<ast_node_base> true_block = try_build_block(con, itr);
+	ast_node_base* true_block = try_build_block(con, itr);
 	if (true_block) {
-		if (ast_node_block* block = static_cast<ast_node_block*>(true_block.get())) {
+		if (ast_node_block* block = static_cast<ast_node_block*>(true_block)) {
 			block->block_name = "true_" + block->block_name;
 		}
 	}
 
 	if (itr->type != lexer::token_type::_else) {
-		return std::make_unique<ast_node_if>(std::move(cond), std::move(true_block));
+		return con.arena->make<ast_node_if>(cond, true_block);
 	}
 	++itr;
-	std::unique_ptr<ast_node_base> false_block = try_build_block(con, itr);
+	ast_node_base* false_block = try_build_block(con, itr);
 	if (false_block) {
-		if (ast_node_block* block = static_cast<ast_node_block*>(false_block.get())) {
+		if (ast_node_block* block = static_cast<ast_node_block*>(false_block)) {
 			block->block_name = "false_" + block->block_name;
 		}
 	}
 
-	return std::make_unique<ast_node_if>(std::move(cond), std::move(true_block), std::move(false_block));
+	return con.arena->make<ast_node_if>(cond, true_block, false_block);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_while(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_while(context& con, lexer::stream& itr) {
 	if (itr->type != lexer::token_type::_while) {
 		return nullptr;
 	}
 	code_point point = itr->point;
 	++itr;
 	if (itr->raw != "(") {
-		return std::make_unique<ast_node_error>("expected `(`", point);
+		return con.arena->make<ast_node_error>("expected `(`", point);
 	}
 	++itr;
-	std::unique_ptr<ast_node_base> condition = try_build_assign(con, itr);
+	ast_node_base* condition = try_build_binary(con, itr);
 	if (!condition) {
-		return std::make_unique<ast_node_error>("expected condition expression", point);
+		return con.arena->make<ast_node_error>("expected condition expression", point);
 	}
 	if (itr->raw != ")") {
-		return std::make_unique<ast_node_error>("expected `)`", point);
+		return con.arena->make<ast_node_error>("expected `)`", point);
 	}
 	++itr;
-	std::unique_ptr<ast_node_base> block = try_build_block(con, itr);
-	return std::make_unique<ast_node_while>(std::move(condition), std::move(block), point);
+	ast_node_base* block = try_build_block(con, itr);
+	return con.arena->make<ast_node_while>(condition, block, point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_do_while(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_do_while(context& con, lexer::stream& itr) {
 	if (itr->type != lexer::token_type::_do) {
 		return nullptr;
 	}
 	code_point point = itr->point;
 	++itr;
-	std::unique_ptr<ast_node_base> block = try_build_block(con, itr);
+	ast_node_base* block = try_build_block(con, itr);
 	if (!block) {
-		return std::make_unique<ast_node_error>("expected code block", point);
+		return con.arena->make<ast_node_error>("expected code block", point);
 	}
 	
 	if (itr->type != lexer::token_type::_while) {
-		return std::make_unique<ast_node_error>("expected `while`", point);
+		return con.arena->make<ast_node_error>("expected `while`", point);
 	}
 	++itr;
 	if (itr->raw != "(") {
-		return std::make_unique<ast_node_error>("expected `(`", point);
+		return con.arena->make<ast_node_error>("expected `(`", point);
 	}
 	++itr;
-	std::unique_ptr<ast_node_base> condition = try_build_assign(con, itr);
+	ast_node_base* condition = try_build_binary(con, itr);
 	if (!condition) {
-		return std::make_unique<ast_node_error>("expected condition expression", point);
+		return con.arena->make<ast_node_error>("expected condition expression", point);
 	}
 	if (itr->raw != ")") {
-		return std::make_unique<ast_node_error>("expected `)`", point);
+		return con.arena->make<ast_node_error>("expected `)`", point);
 	}
 	++itr;
 	if (itr->type != lexer::token_type::semicolon) {
-		return std::make_unique<ast_node_error>("expected `;`", point);
+		return con.arena->make<ast_node_error>("expected `;`", point);
 	}
-	return std::make_unique<ast_node_do_while>(std::move(condition), std::move(block), point);
+	return con.arena->make<ast_node_do_while>(condition, block, point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_block(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_block(context& con, lexer::stream& itr) {
 	if (itr->raw != "{") {
 		return nullptr;
 	}
 	++itr;
-	std::vector<std::unique_ptr<ast_node_base>> exprs;
-	std::unique_ptr<ast_node_base> node;
+	std::vector<ast_node_base*> exprs;
+	ast_node_base* node = nullptr;
 	for (; itr->type != lexer::token_type::eof;) {
-		if (try_skip_comment(itr)) {
-			continue;
-		}
 		if (node = try_build_do_while(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_while(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_if(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_expr(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_return(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_var_definition(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_function(con, itr)) {
-			exprs.push_back(std::make_unique<ast_node_error>("could not define function in the block", node->point));
-		} else if (isspace(itr->raw[0]) || itr->raw == ";") {
+			if (con.pre_evaluate.size() && con.pre_evaluate.back() == node) {
+				con.pre_evaluate.pop_back();
+			}
+			exprs.push_back(con.arena->make<ast_node_error>("could not define function in the block", node->point));
+		} else if (itr->raw == ";") {
 			++itr;
 		} else {
 			break;
 		}
 	}
 	if (itr->raw != "}") {
-		exprs.push_back(std::make_unique<ast_node_error>("expeceted `}`", itr->point));
-		return std::make_unique<ast_node_block>(std::move(exprs), itr->point);
+		exprs.push_back(con.arena->make<ast_node_error>("expeceted `}`", itr->point));
+		return con.arena->make<ast_node_block>(std::move(exprs), itr->point);
 	}
 	if (itr->type != lexer::token_type::eof) {
 		++itr;
 	}
-	return std::make_unique<ast_node_block>(std::move(exprs), itr->point);
+	return con.arena->make<ast_node_block>(std::move(exprs), itr->point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_function(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_function(context& con, lexer::stream& itr) {
 	if (itr->type != lexer::token_type::func) {
 		return nullptr;
 	}
 	++itr;
-	lexer::token func_name_token = *itr;
+	lexer::lexeme func_name_token = *itr;
 	code_point point = itr->point;
 	++itr;
 	if (itr->raw != "(") {
-		return std::make_unique<ast_node_error>("expeceted function name", itr->point);
+		return con.arena->make<ast_node_error>("expeceted function name", itr->point);
 	}
 	++itr;
 	std::vector<context::var_info> args;
@@ -575,21 +518,21 @@ std::unique_ptr<ast_node_base> parser::try_build_function(context& con, std::vec
 			case lexer::token_type::_mut: break;
 			default:
 				std::cout << "invalid modifier (" << itr->raw << ")" << std::endl;
-				return std::make_unique<ast_node_error>("invalid modifier: " + itr->raw, itr->point);
+				return con.arena->make<ast_node_error>("invalid modifier: " + std::string(itr->raw), itr->point);
 			}
 			var.modifier = itr->type;
 			++itr;
 
 			if (itr->type != lexer::token_type::identifier) {
 				std::cout << "expected identifier" << std::endl;
-				return std::make_unique<ast_node_error>("expected identifier", itr->point);
+				return con.arena->make<ast_node_error>("expected identifier", itr->point);
 			}
 			var.name = itr->raw;
 			++itr;
 
 			if (itr->raw != ":") {
 				std::cout << "expected `:`" << std::endl;
-				return std::make_unique<ast_node_error>("expected identifier", itr->point);
+				return con.arena->make<ast_node_error>("expected identifier", itr->point);
 			}
 			++itr;
 
@@ -648,7 +591,7 @@ std::unique_ptr<ast_node_base> parser::try_build_function(context& con, std::vec
 				break;
 			default:
 				std::cout << "invalid type (" << itr->raw << ")" << std::endl;
-				return std::make_unique<ast_node_error>("invalid type (" + itr->raw + ")", point);
+				return con.arena->make<ast_node_error>("invalid type (" + std::string(itr->raw) + ")", point);
 			}
 
 			args.push_back(var);
@@ -657,17 +600,17 @@ std::unique_ptr<ast_node_base> parser::try_build_function(context& con, std::vec
 				break;
 			}
 			if (itr->type != lexer::token_type::comma) {
-				return std::make_unique<ast_node_error>("expected `)` or `,`", point);
+				return con.arena->make<ast_node_error>("expected `)` or `,`", point);
 			}
 			++itr;
 		}
 	}
 	++itr;
 	if (itr->type != lexer::token_type::arrow) {
-		return std::make_unique<ast_node_error>("expeceted `->`", point);
+		return con.arena->make<ast_node_error>("expeceted `->`", point);
 	}
 	++itr;
-	lexer::token return_type_token = *itr++;
+	lexer::lexeme return_type_token = itr++;
 
 	int return_type_size = -1;
 	if (itr->raw == "[") {
@@ -676,46 +619,55 @@ std::unique_ptr<ast_node_base> parser::try_build_function(context& con, std::vec
 			return_type_size = 0;
 			++itr;
 		} else {
-			return std::make_unique<ast_node_error>("return type dimension is empty", itr->point);
+			return con.arena->make<ast_node_error>("return type dimension is empty", itr->point);
 		}
 	}
 
-	std::unique_ptr<ast_node_base> block = try_build_block(con, itr);
-	if (ast_node_block* casted_block = dynamic_cast<ast_node_block*>(block.get())) {
-		casted_block->block_name = func_name_token.raw;
+	ast_node_base* block = nullptr;
+	std::optional<ast_node_function::lazy_body> lazy;
+	if (con.lazy_bodies && itr->raw == "{") {
+		lazy = ast_node_function::lazy_body { .source = itr.source(), .open = *itr, .name = func_name_token, .arena = con.arena };
+		skip_block(itr);
+	} else {
+		block = try_build_block(con, itr);
+		if (block && is_a<ast_node_block>(block)) {
+			ast_node_block* casted_block = static_cast<ast_node_block*>(block);
+			casted_block->block_name = func_name_token.raw;
+		}
 	}
 
 	context::var_type return_type = context::cast_from_token(return_type_token.type, return_type_size >= 0);
 	if (return_type == context::var_type::_invalid) {
 		std::cout << "invalid type (" << itr->raw << ")" << std::endl;
-		return std::make_unique<ast_node_error>("expeceted type (" + itr->raw + ")", point);
+		return con.arena->make<ast_node_error>("expeceted type (" + std::string(itr->raw) + ")", point);
 	}
 
 	if (func_name_token.type != lexer::token_type::identifier) {
-		return std::make_unique<ast_node_error>("expeceted function name", itr->point);
+		return con.arena->make<ast_node_error>("expeceted function name", itr->point);
 	}
 
-	std::unique_ptr<ast_node_function> func = std::make_unique<ast_node_function>();
-	func->block = std::move(block);
+	ast_node_function* func = con.arena->make<ast_node_function>();
+	func->block = block;
+	func->lazy = lazy;
 	func->return_type = return_type;
 	func->return_type_size = return_type_size;
 	func->function_name = func_name_token.raw;
 	func->point = point;
 	func->arguments = std::move(args);
-	con.pre_evaluate.push_back(func.get());
-	return std::move(func);
+	con.pre_evaluate.push_back(func);
+	return func;
 }
 
-std::unique_ptr<ast_node_base> parser::try_class_member_function(context& con, const std::string& name, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_class_member_function(context& con, std::string_view name, lexer::stream& itr) {
 	if (itr->type != lexer::token_type::func) {
 		return nullptr;
 	}
 	++itr;
-	lexer::token func_name_token = *itr;
+	lexer::lexeme func_name_token = *itr;
 	code_point point = itr->point;
 	++itr;
 	if (itr->raw != "(") {
-		return std::make_unique<ast_node_error>("expeceted function name", itr->point);
+		return con.arena->make<ast_node_error>("expeceted function name", itr->point);
 	}
 	++itr;
 	std::vector<context::var_info> args;
@@ -727,21 +679,21 @@ std::unique_ptr<ast_node_base> parser::try_class_member_function(context& con, c
 			case lexer::token_type::_mut: break;
 			default:
 				std::cout << "invalid modifier (" << itr->raw << ")" << std::endl;
-				return std::make_unique<ast_node_error>("invalid modifier: " + itr->raw, itr->point);
+				return con.arena->make<ast_node_error>("invalid modifier: " + std::string(itr->raw), itr->point);
 			}
 			var.modifier = itr->type;
 			++itr;
 
 			if (itr->type != lexer::token_type::identifier) {
 				std::cout << "expected identifier" << std::endl;
-				return std::make_unique<ast_node_error>("expected identifier", itr->point);
+				return con.arena->make<ast_node_error>("expected identifier", itr->point);
 			}
 			var.name = itr->raw;
 			++itr;
 
 			if (itr->raw != ":") {
 				std::cout << "expected `:`" << std::endl;
-				return std::make_unique<ast_node_error>("expected identifier", itr->point);
+				return con.arena->make<ast_node_error>("expected identifier", itr->point);
 			}
 			++itr;
 
@@ -804,7 +756,7 @@ std::unique_ptr<ast_node_base> parser::try_class_member_function(context& con, c
 				break;
 			default:
 				std::cout << "invalid type (" << itr->raw << ")" << std::endl;
-				return std::make_unique<ast_node_error>("invalid type (" + itr->raw + ")", point);
+				return con.arena->make<ast_node_error>("invalid type (" + std::string(itr->raw) + ")", point);
 			}
 
 			args.push_back(var);
@@ -813,17 +765,17 @@ std::unique_ptr<ast_node_base> parser::try_class_member_function(context& con, c
 				break;
 			}
 			if (itr->type != lexer::token_type::comma) {
-				return std::make_unique<ast_node_error>("expected `)` or `,`", point);
+				return con.arena->make<ast_node_error>("expected `)` or `,`", point);
 			}
 			++itr;
 		}
 	}
 	++itr;
 	if (itr->type != lexer::token_type::arrow) {
-		return std::make_unique<ast_node_error>("expeceted `->`", point);
+		return con.arena->make<ast_node_error>("expeceted `->`", point);
 	}
 	++itr;
-	lexer::token return_type_token = *itr++;
+	lexer::lexeme return_type_token = itr++;
 
 	int return_type_size = -1;
 	if (itr->raw == "[") {
@@ -833,61 +785,70 @@ std::unique_ptr<ast_node_base> parser::try_class_member_function(context& con, c
 			++itr;
 		}
 		else {
-			return std::make_unique<ast_node_error>("return type dimension is empty", itr->point);
+			return con.arena->make<ast_node_error>("return type dimension is empty", itr->point);
 		}
 	}
 
-	std::unique_ptr<ast_node_base> block = try_build_block(con, itr);
-	if (ast_node_block* casted_block = dynamic_cast<ast_node_block*>(block.get())) {
-		casted_block->block_name = func_name_token.raw;
+	ast_node_base* block = nullptr;
+	std::optional<ast_node_function::lazy_body> lazy;
+	if (con.lazy_bodies && itr->raw == "{") {
+		lazy = ast_node_function::lazy_body { .source = itr.source(), .open = *itr, .name = func_name_token, .arena = con.arena };
+		skip_block(itr);
+	} else {
+		block = try_build_block(con, itr);
+		if (block && is_a<ast_node_block>(block)) {
+			ast_node_block* casted_block = static_cast<ast_node_block*>(block);
+			casted_block->block_name = func_name_token.raw;
+		}
 	}
 
 	context::var_type return_type = context::cast_from_token(return_type_token.type, return_type_size >= 0);
 	if (return_type == context::var_type::_invalid) {
 		std::cout << "invalid type (" << itr->raw << ")" << std::endl;
-		return std::make_unique<ast_node_error>("expeceted type (" + itr->raw + ")", point);
+		return con.arena->make<ast_node_error>("expeceted type (" + std::string(itr->raw) + ")", point);
 	}
 
 	if (func_name_token.type != lexer::token_type::identifier) {
-		return std::make_unique<ast_node_error>("expeceted function name", itr->point);
+		return con.arena->make<ast_node_error>("expeceted function name", itr->point);
 	}
 
-	std::unique_ptr<ast_node_function> func = std::make_unique<ast_node_function>();
-	func->block = std::move(block);
+	ast_node_function* func = con.arena->make<ast_node_function>();
+	func->block = block;
+	func->lazy = lazy;
 	func->return_type = return_type;
 	func->return_type_size = return_type_size;
-	func->function_name = "class@" + name + "." + func_name_token.raw;
+	func->function_name = "class@" + std::string(name) + "." + std::string(func_name_token.raw);
 	func->point = point;
 	func->arguments = std::move(args);
-	con.pre_evaluate.push_back(func.get());
-	return std::move(func);
+	con.pre_evaluate.push_back(func);
+	return func;
 }
 
-std::unique_ptr<ast_node_base> parser::try_class_block(context& con, const std::string& name, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_class_block(context& con, std::string_view name, lexer::stream& itr) {
 	if (itr->raw != "{") {
 		return nullptr;
 	}
 	code_point point = itr->point;
 	++itr;
-	std::unique_ptr<ast_node_base> node;
-	std::vector<std::unique_ptr<ast_node_base>> nodes;
+	ast_node_base* node = nullptr;
+	std::vector<ast_node_base*> nodes;
 	while (itr->raw != "}") {
 		if (itr->type == lexer::token_type::eof) {
-			return std::make_unique<ast_node_error>("expected `}`", itr->point);
+			return con.arena->make<ast_node_error>("expected `}`", itr->point);
 		}
 		node = try_build_var_definition(con, itr);
-		if (node && is_a<ast_node_var_definition>(node.get())) {
-			ast_node_var_definition* ptr = static_cast<ast_node_var_definition*>(node.get());
+		if (node && is_a<ast_node_var_definition>(node)) {
+			ast_node_var_definition* ptr = static_cast<ast_node_var_definition*>(node);
 			if (ptr->init_value) {
-				nodes.push_back(std::make_unique<ast_node_error>("member variable cannot have initialize value", ptr->point));
+				nodes.push_back(con.arena->make<ast_node_error>("member variable cannot have initialize value", ptr->point));
 			} else {
-				nodes.push_back(std::move(node));
+				nodes.push_back(node);
 			}
 			continue;
 		}
 		node = try_class_member_function(con, name, itr);
 		if (node) {
-			nodes.push_back(std::move(node));
+			nodes.push_back(node);
 			continue;
 		}
 		++itr;
@@ -895,96 +856,233 @@ std::unique_ptr<ast_node_base> parser::try_class_block(context& con, const std::
 	if (itr->type != lexer::token_type::eof) {
 		++itr;
 	}
-	return std::make_unique<ast_node_block>(std::move(nodes), point);
+	return con.arena->make<ast_node_block>(std::move(nodes), point);
 }
 
-std::unique_ptr<ast_node_base> parser::try_build_class(context& con, std::vector<lexer::token>::const_iterator& itr) {
+ast_node_base* parser::try_build_class(context& con, lexer::stream& itr) {
 	if (itr->type != lexer::token_type::_class) {
 		return nullptr;
 	}
 	++itr;
 	code_point point = itr->point;
-	lexer::token name = *itr++;
+	lexer::lexeme name = itr++;
 
-	std::unique_ptr<ast_node_base> block = try_class_block(con, name.raw, itr);
+	ast_node_base* block = try_class_block(con, name.raw, itr);
 	if (!block) {
-		return std::make_unique<ast_node_error>("expected `{`", point);
+		return con.arena->make<ast_node_error>("expected `{`", point);
 	}
-	if (is_a<ast_node_block>(block.get())) {
-		ast_node_block* ptr = static_cast<ast_node_block*>(block.get());
-		ptr->block_name = "class@" + name.raw;
+	if (is_a<ast_node_block>(block)) {
+		ast_node_block* ptr = static_cast<ast_node_block*>(block);
+		ptr->block_name = "class@" + std::string(name.raw);
 	}
 	if (itr->type != lexer::token_type::semicolon) {
-		return std::make_unique<ast_node_error>("expected `;`", itr->point);
+		return con.arena->make<ast_node_error>("expected `;`", itr->point);
 	}
-	return std::make_unique<ast_node_class>(name, std::move(block), point);
+	return con.arena->make<ast_node_class>(name, block, point);
 }
 
-bool parser::try_skip_comment(std::vector<lexer::token>::const_iterator& itr) {
-	if (itr->type == lexer::token_type::comment_begin) {
-		int nest_count = 1;
-		++itr;
-		while (itr->type != lexer::token_type::eof) {
-			if (itr->type == lexer::token_type::comment_begin) {
-				++nest_count;
-			} else if (itr->type == lexer::token_type::comment_end) {
-				++itr;
-				--nest_count;
-				if (!nest_count) {
-					return true;
-				}
-				continue;
-			}
-			++itr;
-		}
-	} else if (itr->type == lexer::token_type::comment_line) {
-		while (itr->type != lexer::token_type::eof) {
-			if (itr->raw == "\n") {
-				++itr;
-				return true;
-			}
-			++itr;
-		}
-	}
-	return false;
-}
-
-std::unique_ptr<ast_node_base> parser::try_build_program(context& con, std::vector<lexer::token>::const_iterator& itr) {
-	std::vector<std::unique_ptr<ast_node_base>> exprs;
-	std::unique_ptr<ast_node_base> node;
+ast_node_base* parser::try_build_program(context& con, lexer::stream& itr) {
+	std::vector<ast_node_base*> exprs;
+	ast_node_base* node = nullptr;
 	for (; itr->type != lexer::token_type::eof;) {
-		if (try_skip_comment(itr)) {
-			continue;
-		}
 		if (node = try_build_function(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_do_while(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_while(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_if(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_expr(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_return(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_var_definition(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_block(con, itr)) {
-			exprs.push_back(std::move(node));
+			exprs.push_back(node);
 		} else if (node = try_build_class(con, itr)) {
-			exprs.push_back(std::move(node));
-		} else if (isspace(itr->raw[0]) || itr->raw == ";") {
+			exprs.push_back(node);
+		} else if (itr->raw == ";") {
 			++itr;
 		} else {
 			break;
 		}
 	}
-	return std::make_unique<ast_node_program>(std::move(exprs), itr->point);
+	return con.arena->make<ast_node_program>(std::move(exprs), itr->point);
+}
+
+std::vector<parser::definition> parser::split_definitions(const lexer::source_map& lines, const std::vector<lexer::token>& toks) {
+	std::vector<definition> definitions;
+	size_t i = 0;
+	while (toks[i].type != lexer::token_type::eof) {
+		if (lines.text_of(toks[i]) == ";") {
+			++i;
+			continue;
+		}
+		if (toks[i].type != lexer::token_type::func && toks[i].type != lexer::token_type::_class) {
+			return {};
+		}
+		size_t first = i++;
+		while (toks[i].type != lexer::token_type::eof && lines.text_of(toks[i]) != "{") {
+			std::string_view text = lines.text_of(toks[i]);
+			if (text == ";" || text == "}" || toks[i].type == lexer::token_type::func || toks[i].type == lexer::token_type::_class) {
+				return {};
+			}
+			++i;
+		}
+		int depth = 0;
+		for (; toks[i].type != lexer::token_type::eof; ++i) {
+			std::string_view text = lines.text_of(toks[i]);
+			if (text == "{") {
+				++depth;
+			} else if (text == "}" && --depth == 0) {
+				break;
+			}
+		}
+		if (toks[i].type == lexer::token_type::eof) {
+			return {};
+		}
+		bool is_class = toks[first].type == lexer::token_type::_class;
+		if (is_class && lines.text_of(toks[++i]) != ";") {
+			return {};
+		}
+		definitions.push_back(definition { .start = lines.decode(toks[first]), .end = toks[i].offset + toks[i].length, .is_class = is_class });
+		++i;
+	}
+	return definitions;
+}
+
+void parser::parse_batches(std::string_view source, const std::vector<definition>& definitions, std::vector<batch>& batches, std::atomic<size_t>& next, ast_arena& arena, bool lazy_bodies) {
+	context con { .stack = operand_stack(0) };
+	con.arena = &arena;
+	con.lazy_bodies = lazy_bodies;
+	for (size_t index = next++; index < batches.size(); index = next++) {
+		batch& work = batches[index];
+		ast_node_block::deferred_names = &work.names;
+		work.complete = true;
+		for (size_t i = work.first; i < work.last; ++i) {
+			lexer::stream itr(source.substr(0, definitions[i].end), definitions[i].start);
+			ast_node_base* node = definitions[i].is_class ? try_build_class(con, itr) : try_build_function(con, itr);
+			if (node && definitions[i].is_class && itr->raw == ";") {
+				++itr;
+			}
+			if (!node || itr->type != lexer::token_type::eof) {
+				work.complete = false;
+				break;
+			}
+			work.nodes.push_back(node);
+		}
+		work.functions = std::move(con.pre_evaluate);
+		con.pre_evaluate.clear();
+	}
+	ast_node_block::deferred_names = nullptr;
 }
 
-std::unique_ptr<ast_node_base> parser::parse(context& con, const std::vector<lexer::token>& toks) noexcept {
-	std::optional<lexer::token> tok = std::nullopt;
-	std::vector<lexer::token>::const_iterator itr = toks.begin();
-	return try_build_program(con, itr);
+ast_node_base* parser::try_build_program_parallel(context& con, std::string_view source, ast_arena& arena) {
+	size_t threads = std::thread::hardware_concurrency();
+	if (threads <= 1 || source.size() < parallel_source) {
+		return nullptr;
+	}
+	lexer::source_map lines(source);
+	std::vector<lexer::token> toks = lexer::tokenize(lines);
+	std::vector<definition> definitions = split_definitions(lines, toks);
+	threads = std::min(threads, definitions.size() / parallel_definitions);
+	if (threads <= 1) {
+		return nullptr;
+	}
+
+	size_t count = threads * 4;
+	std::vector<batch> batches(count);
+	for (size_t i = 0; i < count; ++i) {
+		batches[i].first = definitions.size() * i / count;
+		batches[i].last = definitions.size() * (i + 1) / count;
+	}
+	std::vector<std::unique_ptr<ast_arena>> arenas(threads);
+	std::vector<std::thread> workers;
+	std::atomic<size_t> next { 0 };
+	for (size_t i = 0; i < threads; ++i) {
+		arenas[i] = std::make_unique<ast_arena>();
+		if (i) {
+			workers.emplace_back(parse_batches, source, std::cref(definitions), std::ref(batches), std::ref(next), std::ref(*arenas[i]), con.lazy_bodies);
+		}
+	}
+	parse_batches(source, definitions, batches, next, *arenas[0], con.lazy_bodies);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	for (std::unique_ptr<ast_arena>& worker_arena : arenas) {
+		arena.adopt(std::move(*worker_arena));
+	}
+	for (const batch& work : batches) {
+		if (!work.complete) {
+			return nullptr;
+		}
+	}
+
+	std::vector<ast_node_base*> exprs;
+	exprs.reserve(definitions.size());
+	for (batch& work : batches) {
+		for (std::string* name : work.names) {
+			std::string generated = ast_node_block::generate_blockname();
+			if (!name->empty() && name->back() == ast_node_block::deferred_mark) {
+				name->replace(name->size() - 1, 1, generated);
+			}
+		}
+		exprs.insert(exprs.end(), work.nodes.begin(), work.nodes.end());
+		for (ast_node_base* node : work.functions) {
+			ast_node_function* func = static_cast<ast_node_function*>(node);
+			if (func->lazy) {
+				func->lazy->arena = &arena;
+			}
+			con.pre_evaluate.push_back(node);
+		}
+	}
+	return arena.make<ast_node_program>(std::move(exprs), lines.decode(toks.back()).point);
+}
+
+ast_tree parser::parse(context& con, std::string_view source) noexcept {
+	ast_tree tree { .arena = std::make_unique<ast_arena>(), .root = nullptr };
+	tree.root = try_build_program_parallel(con, source, *tree.arena);
+	if (!tree.root) {
+		lexer::stream itr(source);
+		con.arena = tree.arena.get();
+		tree.root = try_build_program(con, itr);
+		con.arena = nullptr;
+	}
+	resolver::resolve(con, tree.root);
+	constant_folder::fold(con, *tree.arena, tree.root);
+	type_checker::check(con, tree.root);
+	return tree;
+}
+
+ast_node_base* parser::parse_body(context& con, context::func_info& info) {
+	ast_node_function* func = info.function;
+	if (info.block || !func || !func->lazy) {
+		return info.block;
+	}
+	const ast_node_function::lazy_body& lazy = *func->lazy;
+	lexer::stream itr(lazy.source, lazy.open);
+	ast_arena* arena = con.arena;
+	con.arena = lazy.arena;
+	ast_node_base* block = try_build_block(con, itr);
+	con.arena = arena;
+	if (block && is_a<ast_node_block>(block)) {
+		ast_node_block* casted_block = static_cast<ast_node_block*>(block);
+		casted_block->block_name = lazy.name.raw;
+	}
+	func->block = block;
+	resolver::resolve(con, func);
+	constant_folder::fold(con, *lazy.arena, func);
+	func->lazy.reset();
+	type_checker::check(con, func);
+	info.block = block;
+	info.frame_size = func->frame_size;
+	return block;
+}
+
+void parser::parse_all_bodies(context& con) {
+	for (std::pair<const std::string, context::func_info>& func : con.func_table) {
+		parse_body(con, func.second);
+	}
 }
@@ -0,0 +1,137 @@
+#include "resolver.hpp"
+
+
+bool resolver::lookup(state& st, std::string_view name, int& depth, int& slot) {
+	for (std::vector<std::map<std::string, int, std::less<>>>::reverse_iterator scope = st.local_scopes.rbegin(); scope != st.local_scopes.rend(); ++scope) {
+		std::map<std::string, int, std::less<>>::const_iterator itr = scope->find(name);
+		if (itr != scope->end()) {
+			depth = 1;
+			slot = itr->second;
+			return true;
+		}
+	}
+	for (std::vector<std::map<std::string, int, std::less<>>>::reverse_iterator scope = st.global_scopes.rbegin(); scope != st.global_scopes.rend(); ++scope) {
+		std::map<std::string, int, std::less<>>::const_iterator itr = scope->find(name);
+		if (itr != scope->end()) {
+			depth = 0;
+			slot = itr->second;
+			return true;
+		}
+	}
+	depth = -1;
+	slot = -1;
+	return false;
+}
+
+bool resolver::declare(state& st, std::string_view name, int& depth, int& slot) {
+	bool is_local = !st.local_scopes.empty();
+	std::map<std::string, int, std::less<>>& scope = is_local ? st.local_scopes.back() : st.global_scopes.back();
+	if (scope.find(name) != scope.end()) {
+		depth = -1;
+		slot = -1;
+		return false;
+	}
+	depth = is_local ? 1 : 0;
+	slot = is_local ? st.local_count++ : st.global_count++;
+	scope.insert({ std::string(name), slot });
+	return true;
+}
+
+void resolver::resolve_node(state& st, ast_node_base* node) {
+	if (!node) {
+		return;
+	}
+	if (is_a<ast_node_value>(node)) {
+		ast_node_value* value = static_cast<ast_node_value*>(node);
+		if (value->value.type == lexer::token_type::identifier) {
+			lookup(st, value->value.raw, value->depth, value->slot);
+		}
+	} else if (is_a<ast_node_call_function>(node)) {
+		for (ast_node_base* arg : static_cast<ast_node_call_function*>(node)->arguments) {
+			resolve_node(st, arg);
+		}
+	} else if (is_a<ast_node_bin>(node)) {
+		ast_node_bin* bin = static_cast<ast_node_bin*>(node);
+		resolve_node(st, bin->lhs);
+		resolve_node(st, bin->rhs);
+	} else if (is_a<ast_node_expr>(node)) {
+		resolve_node(st, static_cast<ast_node_expr*>(node)->expr);
+	} else if (is_a<ast_node_return>(node)) {
+		resolve_node(st, static_cast<ast_node_return*>(node)->value);
+	} else if (is_a<ast_node_block>(node)) {
+		resolve_block(st, static_cast<ast_node_block*>(node));
+	} else if (is_a<ast_node_repeat>(node)) {
+		ast_node_repeat* repeat = static_cast<ast_node_repeat*>(node);
+		resolve_node(st, repeat->bgn);
+		resolve_node(st, repeat->end);
+	} else if (is_a<ast_node_array_refernce>(node)) {
+		ast_node_array_refernce* reference = static_cast<ast_node_array_refernce*>(node);
+		lookup(st, reference->name.raw, reference->depth, reference->slot);
+		resolve_node(st, reference->index);
+	} else if (is_a<ast_node_var_definition>(node)) {
+		ast_node_var_definition* definition = static_cast<ast_node_var_definition*>(node);
+		resolve_node(st, definition->init_value);
+		declare(st, definition->name, definition->depth, definition->slot);
+	} else if (is_a<ast_node_if>(node)) {
+		ast_node_if* branch = static_cast<ast_node_if*>(node);
+		resolve_node(st, branch->condition_block);
+		resolve_node(st, branch->true_block);
+		resolve_node(st, branch->false_block);
+	} else if (is_a<ast_node_while>(node)) {
+		ast_node_while* loop = static_cast<ast_node_while*>(node);
+		resolve_node(st, loop->condition);
+		resolve_node(st, loop->block);
+	} else if (is_a<ast_node_do_while>(node)) {
+		ast_node_do_while* loop = static_cast<ast_node_do_while*>(node);
+		resolve_node(st, loop->block);
+		resolve_node(st, loop->condition);
+	} else if (is_a<ast_node_initial_list>(node)) {
+		for (ast_node_base* value : static_cast<ast_node_initial_list*>(node)->values) {
+			resolve_node(st, value);
+		}
+	} else if (is_a<ast_node_program>(node)) {
+		for (ast_node_base* item : static_cast<ast_node_program*>(node)->exprs) {
+			resolve_node(st, item);
+		}
+	}
+}
+
+void resolver::resolve_block(state& st, ast_node_block* node) {
+	std::vector<std::map<std::string, int, std::less<>>>& scopes = st.local_scopes.empty() ? st.global_scopes : st.local_scopes;
+	scopes.push_back({});
+	for (ast_node_base* item : node->exprs) {
+		resolve_node(st, item);
+	}
+	scopes.pop_back();
+}
+
+void resolver::resolve_function(state& st, ast_node_function* node) {
+	st.local_scopes.push_back({});
+	st.local_count = 0;
+	int depth = -1, slot = -1;
+	for (const context::var_info& arg : node->arguments) {
+		if (!declare(st, arg.name, depth, slot)) {
+			++st.local_count;
+		}
+	}
+	resolve_node(st, node->block);
+	node->frame_size = st.local_count;
+	st.local_scopes.clear();
+}
+
+void resolver::resolve(context& con, ast_node_base* root) {
+	state st { .global_scopes = { {} }, .local_scopes = {}, .global_count = 0, .local_count = 0 };
+	resolve_node(st, root);
+	for (ast_node_base* node : con.pre_evaluate) {
+		if (is_a<ast_node_function>(node)) {
+			resolve_function(st, static_cast<ast_node_function*>(node));
+		}
+	}
+	con.globals.resize(st.global_count);
+	con.global_slots = std::move(st.global_scopes.front());
+}
+
+void resolver::resolve(context& con, ast_node_function* node) {
+	state st { .global_scopes = { con.global_slots }, .local_scopes = {}, .global_count = static_cast<int>(con.globals.size()), .local_count = 0 };
+	resolve_function(st, node);
+}
@@ -1,9 +1,10 @@
 #include "runtime.hpp"
 #include <iostream>
 #include "state.hpp"
+#include "vm.hpp"
 
 
-OBJECT runtime::evaluate(const std::unique_ptr<ast_node_base>& node, context& con) {
+OBJECT runtime::evaluate(ast_node_base* node, context& con) {
 	for (ast_node_base* node : con.pre_evaluate) {
 		con.return_code = node->evaluate(con);
 	}
@@ -19,7 +20,17 @@ OBJECT runtime::evaluate(const std::unique_ptr<ast_node_base>& node, context& co
 	return invalid_state("program in empty");
 }
 
-OBJECT runtime::evaluate(const std::unique_ptr<ast_node_base>& node) {
+OBJECT runtime::evaluate(ast_node_base* node, context& con, engine kind) {
+	if (kind == engine::tree_walk) {
+		return evaluate(node, con);
+	}
+	evaluate_pre_process(con);
+	parser::parse_all_bodies(con);
+	bytecode program = compiler::compile(con, node);
+	return vm::execute(con, program);
+}
+
+OBJECT runtime::evaluate(ast_node_base* node) {
 	context con { .return_code = std::nullopt, .is_abort = false };
 	if (std::optional<invalid_state> state = node->evaluate(con)) {
 		return state.value();
@@ -30,6 +41,28 @@ OBJECT runtime::evaluate(const std::unique_ptr<ast_node_base>& node) {
 	}
 }
 
+OBJECT runtime::evaluate_function(ast_node_base* node, context& con, const std::string& name, engine kind) {
+	std::map<std::string, context::func_info>::iterator itr = con.func_table.find(name);
+	if (itr == con.func_table.end() || !parser::parse_body(con, itr->second)) {
+		return invalid_state("not found " + name + "()");
+	}
+	if (kind == engine::bytecode_vm) {
+		parser::parse_all_bodies(con);
+		bytecode program = compiler::compile(con, node);
+		return vm::call(con, program, name);
+	}
+	size_t caller = con.enter_frame(con.reserve_frame(itr->second.frame_size));
+	std::optional<invalid_state> state = itr->second.block->evaluate(con);
+	con.leave_frame(caller);
+	if (state) {
+		return state.value();
+	}
+	if (con.stack.size()) {
+		return con.stack.back();
+	}
+	return invalid_state("no return value");
+}
+
 void runtime::evaluate_pre_process(context& con) {
 	for (ast_node_base* node : con.pre_evaluate) {
 		con.return_code = node->evaluate(con);
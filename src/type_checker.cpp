@@ -0,0 +1,342 @@
+#include "type_checker.hpp"
+#include <iostream>
+
+
+context::var_type type_checker::array_of(context::var_type type) {
+	switch (type) {
+	case context::var_type::_bool: return context::var_type::_bool_array;
+	case context::var_type::_int: return context::var_type::_int_array;
+	case context::var_type::_float: return context::var_type::_float_array;
+	case context::var_type::_str: return context::var_type::_str_array;
+	default: return context::var_type::_invalid;
+	}
+}
+
+context::var_type type_checker::element_of(context::var_type type) {
+	switch (type) {
+	case context::var_type::_bool_array: return context::var_type::_bool;
+	case context::var_type::_int_array: return context::var_type::_int;
+	case context::var_type::_float_array: return context::var_type::_float;
+	case context::var_type::_str_array: return context::var_type::_str;
+	default: return context::var_type::_invalid;
+	}
+}
+
+bool type_checker::is_operable(ast_node_bin::op_type op, context::var_type type) {
+	switch (type) {
+	case context::var_type::_int:
+	case context::var_type::_float:
+		return true;
+	case context::var_type::_str:
+		return op != ast_node_bin::op_type::sub && op != ast_node_bin::op_type::mul && op != ast_node_bin::op_type::div;
+	case context::var_type::_bool:
+	case context::var_type::_bool_array:
+	case context::var_type::_invalid:
+		return false;
+	default:
+		return op == ast_node_bin::op_type::add;
+	}
+}
+
+void type_checker::report(code_point point, const std::string& message) {
+	std::cout << "type error (" << point.line << ", " << point.col << "): " << message << std::endl;
+}
+
+ast_node_function* type_checker::find_function(state& st, const std::string& name) {
+	if (!st.functions.empty()) {
+		std::map<std::string_view, ast_node_function*>::iterator itr = st.functions.find(name);
+		return itr != st.functions.end() ? itr->second : nullptr;
+	}
+	std::map<std::string, context::func_info>::iterator itr = st.con.func_table.find(name);
+	return itr != st.con.func_table.end() ? itr->second.function : nullptr;
+}
+
+context::var_type type_checker::type_of_var(state& st, int depth, int slot) {
+	if (depth != 1 || slot < 0 || slot >= static_cast<int>(st.types.size())) {
+		return context::var_type::_invalid;
+	}
+	return st.types[slot];
+}
+
+void type_checker::declare(state& st, int depth, int slot, context::var_type type, lexer::token_type modifier) {
+	if (depth != 1 || slot < 0 || slot >= static_cast<int>(st.types.size())) {
+		return;
+	}
+	st.types[slot] = type;
+	st.modifiers[slot] = modifier;
+}
+
+context::var_type type_checker::check_value(state& st, ast_node_value* node) {
+	if (node->value.type != lexer::token_type::identifier) {
+		return static_cast<context::var_type>(node->constant.index());
+	}
+	context::var_type type = type_of_var(st, node->depth, node->slot);
+	node->typed = type != context::var_type::_invalid;
+	return type;
+}
+
+context::var_type type_checker::check_call(state& st, ast_node_call_function* node) {
+	std::vector<context::var_type> types;
+	for (ast_node_base* arg : node->arguments) {
+		types.push_back(check_node(st, arg));
+	}
+	ast_node_function* func = find_function(st, node->function_name);
+	if (!func) {
+		report(node->point, "not found method(" + node->function_name + ")");
+		return context::var_type::_invalid;
+	}
+	if (func->arguments.size() != types.size()) {
+		report(node->point, "the count of arguments is mismatch (" + node->function_name + ")");
+		return func->return_type;
+	}
+	bool typed = true;
+	for (size_t i = 0; i < types.size(); ++i) {
+		context::var_type expected = func->arguments[i].type;
+		if (types[i] == expected) {
+			continue;
+		}
+		typed = false;
+		if (types[i] != context::var_type::_invalid) {
+			report(node->arguments[i]->point, "expected `" + type_names[static_cast<int>(expected)] + "` actual `" + type_names[static_cast<int>(types[i])] + "` at index: " + std::to_string(i + 1));
+		}
+	}
+	node->typed = typed;
+	return func->return_type;
+}
+
+context::var_type type_checker::check_assign(state& st, ast_node_bin* node) {
+	context::var_type target = check_node(st, node->lhs);
+	context::var_type value = check_node(st, node->rhs);
+	std::string_view name;
+	int depth = -1, slot = -1;
+	if (node->lhs && is_a<ast_node_value>(node->lhs)) {
+		ast_node_value* variable = static_cast<ast_node_value*>(node->lhs);
+		name = variable->value.raw;
+		depth = variable->depth;
+		slot = variable->slot;
+		node->typed = target != context::var_type::_invalid && target == value;
+	} else if (node->lhs && is_a<ast_node_array_refernce>(node->lhs)) {
+		ast_node_array_refernce* reference = static_cast<ast_node_array_refernce*>(node->lhs);
+		name = reference->name.raw;
+		depth = reference->depth;
+		slot = reference->slot;
+		node->typed = reference->typed && target == value;
+	} else {
+		return context::var_type::_invalid;
+	}
+	if (type_of_var(st, depth, slot) != context::var_type::_invalid && st.modifiers[slot] == lexer::token_type::_const) {
+		report(node->lhs->point, "not constant value(" + std::string(name) + ")");
+	}
+	if (target != context::var_type::_invalid && value != context::var_type::_invalid && target != value) {
+		report(node->lhs->point, "assign different type(`" + type_names[static_cast<int>(target)] + "` != `" + type_names[static_cast<int>(value)] + "`)");
+	}
+	return context::var_type::_invalid;
+}
+
+context::var_type type_checker::check_bin(state& st, ast_node_bin* node) {
+	context::var_type lhs = check_node(st, node->lhs);
+	context::var_type rhs = check_node(st, node->rhs);
+	if (lhs == context::var_type::_invalid || rhs == context::var_type::_invalid) {
+		return context::var_type::_invalid;
+	}
+	if (lhs != rhs) {
+		report(node->point, "different type(`" + type_names[static_cast<int>(lhs)] + "` " + ast_node_bin::sign_of(node->op) + " `" + type_names[static_cast<int>(rhs)] + "`)");
+		return context::var_type::_invalid;
+	}
+	if (!is_operable(node->op, lhs)) {
+		report(node->point, std::string("operator `") + ast_node_bin::sign_of(node->op) + "` is not defined for `" + type_names[static_cast<int>(lhs)] + "`");
+		return context::var_type::_invalid;
+	}
+	node->typed = lhs == context::var_type::_int || lhs == context::var_type::_float || lhs == context::var_type::_str;
+	node->operand_type = lhs;
+	if (node->op >= ast_node_bin::op_type::equal) {
+		return context::var_type::_bool;
+	}
+	return lhs;
+}
+
+context::var_type type_checker::check_initial_list(state& st, ast_node_initial_list* node) {
+	context::var_type element = context::var_type::_invalid;
+	bool known = true;
+	int count = 0;
+	for (ast_node_base* value : node->values) {
+		if (is_a<ast_node_error>(value)) {
+			return context::var_type::_invalid;
+		}
+		if (!is_a<ast_node_value>(value) && !is_a<ast_node_string>(value)) {
+			++count;
+			continue;
+		}
+		context::var_type type = check_node(st, value);
+		if (type == context::var_type::_invalid) {
+			known = false;
+		} else if (element == context::var_type::_invalid) {
+			element = type;
+		} else if (type != element) {
+			report(node->point, "different type is found in the initialize list (index: " + std::to_string(count) + ")");
+			known = false;
+		}
+		++count;
+	}
+	return known ? array_of(element) : context::var_type::_invalid;
+}
+
+void type_checker::check_var_definition(state& st, ast_node_var_definition* node) {
+	context::var_type init = check_node(st, node->init_value);
+	if (node->init_value && init != context::var_type::_invalid && init != node->type && node->type != context::var_type::_invalid) {
+		report(node->init_value->point, "initial value is not " + type_names[static_cast<int>(node->type)] + " (" + node->name + ")");
+	}
+	node->typed = !node->init_value || init == node->type;
+	if (node->size < 0) {
+		declare(st, node->depth, node->slot, node->type, node->modifier);
+	} else {
+		declare(st, node->depth, node->slot, node->init_value ? init : context::var_type::_invalid, node->modifier);
+	}
+}
+
+void type_checker::check_condition(state& st, ast_node_base* node, ast_node_base* condition) {
+	context::var_type type = check_node(st, condition);
+	if (element_of(type) != context::var_type::_invalid) {
+		report(condition->point, "condition is not convertible to bool (`" + type_names[static_cast<int>(type)] + "`)");
+	}
+	node->typed = type == context::var_type::_bool;
+}
+
+context::var_type type_checker::check_node(state& st, ast_node_base* node) {
+	if (!node) {
+		return context::var_type::_invalid;
+	}
+	switch (node->kind) {
+	case node_kind::string:
+		return context::var_type::_str;
+	case node_kind::value:
+		return check_value(st, static_cast<ast_node_value*>(node));
+	case node_kind::call_function:
+		return check_call(st, static_cast<ast_node_call_function*>(node));
+	case node_kind::bin: {
+		ast_node_bin* bin = static_cast<ast_node_bin*>(node);
+		return bin->op == ast_node_bin::op_type::assign ? check_assign(st, bin) : check_bin(st, bin);
+	}
+	case node_kind::expr:
+		return check_node(st, static_cast<ast_node_expr*>(node)->expr);
+	case node_kind::_return: {
+		ast_node_return* ret = static_cast<ast_node_return*>(node);
+		context::var_type type = check_node(st, ret->value);
+		if (type != st.return_type || st.loop_depth) {
+			st.returns_typed = false;
+		}
+		if (type != context::var_type::_invalid && st.return_type != context::var_type::_invalid && type != st.return_type) {
+			report(ret->point, "expected " + type_names[static_cast<int>(st.return_type)] + " value as return value (type: `" + type_names[static_cast<int>(type)] + "`)");
+		}
+		return context::var_type::_invalid;
+	}
+	case node_kind::block:
+		for (ast_node_base* item : static_cast<ast_node_block*>(node)->exprs) {
+			check_node(st, item);
+		}
+		node->typed = true;
+		return context::var_type::_invalid;
+	case node_kind::repeat: {
+		ast_node_repeat* repeat = static_cast<ast_node_repeat*>(node);
+		context::var_type bgn = check_node(st, repeat->bgn);
+		context::var_type end = check_node(st, repeat->end);
+		if (bgn == context::var_type::_invalid || end == context::var_type::_invalid) {
+			return context::var_type::_invalid;
+		}
+		if (bgn != end || (bgn != context::var_type::_int && bgn != context::var_type::_str)) {
+			report(repeat->point, "failed to evaluate repeat expression (`" + type_names[static_cast<int>(bgn)] + "`...`" + type_names[static_cast<int>(end)] + "`)");
+			return context::var_type::_invalid;
+		}
+		return array_of(bgn);
+	}
+	case node_kind::array_reference: {
+		ast_node_array_refernce* reference = static_cast<ast_node_array_refernce*>(node);
+		context::var_type index = check_node(st, reference->index);
+		context::var_type array = type_of_var(st, reference->depth, reference->slot);
+		if (index != context::var_type::_invalid && index != context::var_type::_int) {
+			report(reference->point, "index is invalid");
+		}
+		if (array != context::var_type::_invalid && element_of(array) == context::var_type::_invalid) {
+			report(reference->point, "`" + std::string(reference->name.raw) + "` is not an array");
+		}
+		reference->typed = index == context::var_type::_int && element_of(array) != context::var_type::_invalid;
+		return element_of(array);
+	}
+	case node_kind::var_definition:
+		check_var_definition(st, static_cast<ast_node_var_definition*>(node));
+		return context::var_type::_invalid;
+	case node_kind::_if: {
+		ast_node_if* branch = static_cast<ast_node_if*>(node);
+		check_condition(st, branch, branch->condition_block);
+		check_node(st, branch->true_block);
+		check_node(st, branch->false_block);
+		return context::var_type::_invalid;
+	}
+	case node_kind::_while: {
+		ast_node_while* loop = static_cast<ast_node_while*>(node);
+		check_condition(st, loop, loop->condition);
+		++st.loop_depth;
+		check_node(st, loop->block);
+		--st.loop_depth;
+		return context::var_type::_invalid;
+	}
+	case node_kind::do_while: {
+		ast_node_do_while* loop = static_cast<ast_node_do_while*>(node);
+		++st.loop_depth;
+		check_node(st, loop->block);
+		--st.loop_depth;
+		check_condition(st, loop, loop->condition);
+		return context::var_type::_invalid;
+	}
+	case node_kind::initial_list:
+		return check_initial_list(st, static_cast<ast_node_initial_list*>(node));
+	case node_kind::program:
+		for (ast_node_base* item : static_cast<ast_node_program*>(node)->exprs) {
+			check_node(st, item);
+		}
+		return context::var_type::_invalid;
+	default:
+		return context::var_type::_invalid;
+	}
+}
+
+void type_checker::check_function(state& st, ast_node_function* node) {
+	if (!node->block) {
+		return;
+	}
+	st.types.assign(node->frame_size, context::var_type::_invalid);
+	st.modifiers.assign(node->frame_size, lexer::token_type::unknown);
+	for (size_t i = 0; i < node->arguments.size() && i < st.types.size(); ++i) {
+		st.types[i] = node->arguments[i].type;
+		st.modifiers[i] = node->arguments[i].modifier;
+	}
+	st.return_type = node->return_type;
+	st.returns_typed = true;
+	st.loop_depth = 0;
+	check_node(st, node->block);
+	if (is_a<ast_node_block>(node->block)) {
+		static_cast<ast_node_block*>(node->block)->owner = node;
+	}
+	node->typed = st.returns_typed;
+}
+
+void type_checker::check(context& con, ast_node_base* root) {
+	state st { .con = con, .functions = {}, .types = {}, .modifiers = {}, .return_type = context::var_type::_invalid, .returns_typed = false, .loop_depth = 0 };
+	for (ast_node_base* node : con.pre_evaluate) {
+		if (is_a<ast_node_function>(node)) {
+			ast_node_function* func = static_cast<ast_node_function*>(node);
+			st.functions.emplace(func->function_name, func);
+		}
+	}
+	check_node(st, root);
+	for (ast_node_base* node : con.pre_evaluate) {
+		if (is_a<ast_node_function>(node)) {
+			check_function(st, static_cast<ast_node_function*>(node));
+		}
+	}
+}
+
+void type_checker::check(context& con, ast_node_function* node) {
+	state st { .con = con, .functions = {}, .types = {}, .modifiers = {}, .return_type = context::var_type::_invalid, .returns_typed = false, .loop_depth = 0 };
+	check_function(st, node);
+}
@@ -0,0 +1,397 @@
+#include "vm.hpp"
+#include <iostream>
+
+
+static const char* opcode_signs[] = {
+	"+", "-", "*", "/", "==", "!=", "<", ">", "<=", ">=",
+};
+
+OBJECT vm::binary(opcode op, OBJECT& lhs, OBJECT& rhs) {
+	switch (op) {
+	case opcode::add: return visit_object(operate_add_object(-1, -1), lhs, rhs);
+	case opcode::sub: return visit_object(operate_sub_object(-1, -1), lhs, rhs);
+	case opcode::mul: return visit_object(operate_mul_object(-1, -1), lhs, rhs);
+	case opcode::div: return visit_object(operate_div_object(-1, -1), lhs, rhs);
+	case opcode::equal: return visit_object(operate_equal_object(-1, -1), lhs, rhs);
+	case opcode::not_equal: return visit_object(operate_not_object(-1, -1), lhs, rhs);
+	case opcode::less_than: return visit_object(operate_less_than_object(-1, -1), lhs, rhs);
+	case opcode::greater_than: return visit_object(operate_greater_than_object(-1, -1), lhs, rhs);
+	case opcode::less_than_or_equal: return visit_object(operate_less_than_or_equal_object(-1, -1), lhs, rhs);
+	case opcode::greater_than_or_equal: return visit_object(operate_greater_than_or_equal_object(-1, -1), lhs, rhs);
+	default: return invalid_state("no result");
+	}
+}
+
+OBJECT vm::execute(context& con, const bytecode& program) {
+	std::vector<frame> frames;
+	run(con, program, 0, frames);
+	if (con.stack.size()) {
+		return con.stack.back();
+	}
+	return invalid_state("program in empty");
+}
+
+OBJECT vm::call(context& con, const bytecode& program, const std::string& name) {
+	std::map<std::string, int>::const_iterator itr = program.function_index.find(name);
+	if (itr == program.function_index.end() || program.functions[itr->second].entry < 0) {
+		return invalid_state("not found method(" + name + ")");
+	}
+	std::vector<frame> frames;
+	size_t caller = con.enter_frame(con.reserve_frame(program.functions[itr->second].info->frame_size));
+	frames.push_back(frame { .return_address = -1, .function = itr->second, .stack_base = con.stack.size(), .caller_base = caller });
+	run(con, program, program.functions[itr->second].entry, frames);
+	if (con.stack.size()) {
+		return con.stack.back();
+	}
+	return invalid_state("no return value");
+}
+
+void vm::run(context& con, const bytecode& program, int ip, std::vector<frame>& frames) {
+	operand_stack& stack = con.stack;
+	const instruction* code = program.code.data();
+
+	while (true) {
+		const instruction& inst = code[ip];
+		switch (inst.op) {
+		case opcode::push_const:
+			stack.push_back(program.constants[inst.operand]);
+			++ip;
+			break;
+		case opcode::load_var: {
+			const bytecode::variable_reference& reference = program.references[inst.operand];
+			context::var_info* var = ast_evaluator::find_var(con, reference.depth, reference.slot);
+			if (!var) {
+				std::cout << "runtime error (" << program.points[ip].line << ", " << program.points[ip].col << "): undefined method(" << reference.name << ")" << std::endl;
+				con.abort();
+			}
+			stack.push_back(var->value);
+			++ip;
+			break;
+		}
+		case opcode::store_var: {
+			const code_point& point = program.points[ip];
+			const bytecode::variable_reference& reference = program.references[inst.operand];
+			context::var_info* var = ast_evaluator::find_var(con, reference.depth, reference.slot);
+			if (!var) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): not found method(" << reference.name << ")" << std::endl;
+				con.abort();
+			}
+			if (var->modifier == lexer::token_type::_const) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): not constant value(" << reference.name << ")" << std::endl;
+				con.abort();
+			}
+			if (var->value.index() != stack.back().index()) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): assign different type(`" << visit_object(get_object_type_name {}, var->value) << "` != `" << visit_object(get_object_type_name {}, stack.back()) << "`)" << std::endl;
+				con.abort();
+			}
+			var->value = std::move(stack.back());
+			stack.pop_back();
+			++ip;
+			break;
+		}
+		case opcode::define_var: {
+			const bytecode::variable_definition& definition = program.definitions[inst.operand];
+			const code_point& point = program.points[ip];
+			const code_point& init_point = definition.init_point;
+			if (definition.slot < 0) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): variable double definition (" << definition.name << ")" << std::endl;
+				con.abort();
+			}
+			OBJECT value = 0;
+			if (definition.has_init) {
+				value = std::move(stack.back());
+				stack.pop_back();
+				if (definition.size == 0) {
+					if (!definition.is_list_init) {
+						std::cout << "runtime error (" << init_point.line << ", " << init_point.col << "): array = `not initialize list`; " << std::endl;
+						con.abort();
+					}
+				} else if (definition.size > 0) {
+					int init_value_size = visit_object(get_array_size {}, value);
+					if (init_value_size < 0) {
+						std::cout << "runtime error (" << init_point.line << ", " << init_point.col << "): invalid initialize_list" << std::endl;
+						con.abort();
+					}
+					if (definition.size < init_value_size) {
+						std::cout << "runtime error (" << init_point.line << ", " << init_point.col << "): ";
+						std::cout << "the array size < the size of initialize_list (" << definition.size << "<" << init_value_size << ")" << std::endl;
+						con.abort();
+					}
+					for (int i = init_value_size; i < definition.size; ++i) {
+						value.detach();
+						visit_object(insert_to_array(-1), value);
+					}
+				}
+				if (definition.size != 0) {
+					if (definition.type == context::var_type::_bool && value.index() != bool_index) {
+						std::cout << "runtime error (" << init_point.line << ", " << init_point.col << "): initial value is not bool (" << definition.name << ")" << std::endl;
+						con.abort();
+					} else if (definition.type == context::var_type::_int && value.index() != int_index) {
+						std::cout << "runtime error (" << init_point.line << ", " << init_point.col << "): initial value is not int (" << definition.name << ")" << std::endl;
+						con.abort();
+					} else if (definition.type == context::var_type::_float && value.index() != float_index) {
+						std::cout << "runtime error (" << init_point.line << ", " << init_point.col << "): initial value is not float (" << definition.name << ")" << std::endl;
+						con.abort();
+					} else if (definition.type == context::var_type::_str && value.index() != string_index) {
+						std::cout << "runtime error (" << init_point.line << ", " << init_point.col << "): initial value is not str (" << definition.name << ")" << std::endl;
+						con.abort();
+					}
+				}
+			} else {
+				switch (definition.type) {
+				case context::var_type::_int:
+					value = definition.size >= 0 ? OBJECT(std::vector<int>(definition.size, 0)) : OBJECT(0);
+					break;
+				case context::var_type::_float:
+					value = definition.size >= 0 ? OBJECT(std::vector<float>(definition.size, 0.f)) : OBJECT(0.f);
+					break;
+				case context::var_type::_bool:
+					value = definition.size >= 0 ? OBJECT(std::vector<bool>(definition.size, false)) : OBJECT(false);
+					break;
+				case context::var_type::_str:
+					value = definition.size >= 0 ? OBJECT(std::vector<std::string>(definition.size, "")) : OBJECT(std::string());
+					break;
+				default:
+					break;
+				}
+			}
+			context::var_info& var = definition.depth ? con.slots[con.frame_base + definition.slot] : con.globals[definition.slot];
+			var = context::var_info { .modifier = definition.modifier, .type = definition.type, .value = std::move(value) };
+			++ip;
+			break;
+		}
+		case opcode::load_index: {
+			const code_point& point = program.points[ip];
+			OBJECT index = std::move(stack.back());
+			stack.pop_back();
+			if (index.index() != int_index) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): index is invalid" << std::endl;
+				con.abort();
+			}
+			const bytecode::variable_reference& reference = program.references[inst.operand];
+			context::var_info* var = ast_evaluator::find_var(con, reference.depth, reference.slot);
+			if (!var) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): undefined method(" << reference.name << ")" << std::endl;
+				con.abort();
+			}
+			OBJECT value = visit_object(operate_index_ref_object(index.get<int>()), var->value);
+			if (value.index() == state_index) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): " << value.get<invalid_state>().message << std::endl;
+				con.abort();
+			}
+			stack.push_back(std::move(value));
+			++ip;
+			break;
+		}
+		case opcode::store_index: {
+			const code_point& point = program.points[ip];
+			OBJECT index = std::move(stack.back());
+			stack.pop_back();
+			OBJECT value = std::move(stack.back());
+			stack.pop_back();
+			const std::string& name = program.references[inst.operand].name;
+			context::var_info* var = ast_evaluator::find_var(con, program.references[inst.operand].depth, program.references[inst.operand].slot);
+			if (!var) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): not found method(" << name << ")" << std::endl;
+				con.abort();
+			}
+			if (var->modifier == lexer::token_type::_const) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): not constant value(" << name << ")" << std::endl;
+				con.abort();
+			}
+			if (var->value.index() == float_array_index && value.index() != float_index) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): assign different type(`float array` != `" << visit_object(get_object_type_name {}, value) << "`)" << std::endl;
+				con.abort();
+			} else if (var->value.index() == int_array_index && value.index() != int_index) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): assign different type(`int array" << visit_object(get_object_type_name {}, var->value) << "` != `" << visit_object(get_object_type_name {}, value) << "`)" << std::endl;
+				con.abort();
+			} else if (var->value.index() == bool_array_index && value.index() != bool_index) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): assign different type(`bool array" << visit_object(get_object_type_name {}, var->value) << "` != `" << visit_object(get_object_type_name {}, value) << "`)" << std::endl;
+				con.abort();
+			}
+			if (index.index() != int_index) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): assign different type(`" << visit_object(get_object_type_name {}, var->value) << "` != `" << visit_object(get_object_type_name {}, value) << "`)" << std::endl;
+				con.abort();
+			}
+			var->value.detach();
+			OBJECT result = visit_object(operate_assign_object(index.get<int>()), var->value, value);
+			if (result.index() == state_index) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): out of range (" << index.get<int>() << ")" << std::endl;
+				con.abort();
+			}
+			++ip;
+			break;
+		}
+		case opcode::make_array: {
+			const code_point& point = program.points[ip];
+			OBJECT object;
+			size_t first = stack.size() - inst.operand;
+			for (size_t i = first; i < stack.size(); ++i) {
+				if (i == first) {
+					object = visit_object(make_array {}, stack[i]);
+				} else if (stack[i].index() != stack[first].index()) {
+					std::cout << "runtime error (" << point.line << ", " << point.col << "): different type is found in the initialize list (index: " << i - first << ")" << std::endl;
+					con.abort();
+				} else {
+					visit_object(insert_to_array(-1), object, stack[i]);
+				}
+			}
+			stack.resize(first);
+			stack.push_back(std::move(object));
+			++ip;
+			break;
+		}
+		case opcode::make_range: {
+			OBJECT end_value = std::move(stack.back()); stack.pop_back();
+			OBJECT bgn_value = std::move(stack.back()); stack.pop_back();
+			OBJECT list = visit_object(operate_repeat_object {}, bgn_value, end_value);
+			if (list.index() == state_index) {
+				std::cout << "runtime error (" << program.points[ip].line << ", " << program.points[ip].col << "): " << list.get<invalid_state>().message << std::endl;
+				con.abort();
+			}
+			stack.push_back(std::move(list));
+			++ip;
+			break;
+		}
+		case opcode::add:
+		case opcode::sub:
+		case opcode::mul:
+		case opcode::div:
+		case opcode::equal:
+		case opcode::not_equal:
+		case opcode::less_than:
+		case opcode::greater_than:
+		case opcode::less_than_or_equal:
+		case opcode::greater_than_or_equal: {
+			OBJECT& lhs = stack[stack.size() - 2];
+			OBJECT& rhs = stack.back();
+			if (const int* l = lhs.get_if<int>()) {
+				if (const int* r = rhs.get_if<int>()) {
+					int a = *l, b = *r;
+					switch (inst.op) {
+					case opcode::add: lhs = a + b; stack.pop_back(); ++ip; continue;
+					case opcode::sub: lhs = a - b; stack.pop_back(); ++ip; continue;
+					case opcode::mul: lhs = a * b; stack.pop_back(); ++ip; continue;
+					case opcode::equal: lhs = a == b; stack.pop_back(); ++ip; continue;
+					case opcode::not_equal: lhs = a != b; stack.pop_back(); ++ip; continue;
+					case opcode::less_than: lhs = a < b; stack.pop_back(); ++ip; continue;
+					case opcode::greater_than: lhs = a > b; stack.pop_back(); ++ip; continue;
+					case opcode::less_than_or_equal: lhs = a <= b; stack.pop_back(); ++ip; continue;
+					case opcode::greater_than_or_equal: lhs = a >= b; stack.pop_back(); ++ip; continue;
+					default: break;
+					}
+				}
+			}
+			const code_point& point = program.points[ip];
+			if (lhs.index() != rhs.index()) {
+				std::cout << "runtime error (" << point.line << "," << point.col << "): assign different type(`" << visit_object(get_object_type_name {}, lhs) << "` " << opcode_signs[static_cast<int>(inst.op) - static_cast<int>(opcode::add)] << " `" << visit_object(get_object_type_name {}, rhs) << "`)" << std::endl;
+				con.abort();
+			}
+			OBJECT result = binary(inst.op, lhs, rhs);
+			if (result.index() == state_index) {
+				if (inst.op == opcode::div) {
+					std::cout << "runtime error (" << point.line << ", " << point.col << "): divide by zero" << std::endl;
+				} else {
+					std::cout << "runtime error (" << point.line << ", " << point.col << "): " << result.get<invalid_state>().message << std::endl;
+				}
+				con.abort();
+			}
+			stack.pop_back();
+			stack.back() = std::move(result);
+			++ip;
+			break;
+		}
+		case opcode::pop:
+			stack.pop_back();
+			++ip;
+			break;
+		case opcode::dup:
+			stack.push_back(stack.back());
+			++ip;
+			break;
+		case opcode::jump:
+			ip = inst.operand;
+			break;
+		case opcode::jump_if_false: {
+			OBJECT cond = visit_object(cast_bool_object {}, stack.back());
+			stack.pop_back();
+			if (cond.index() != bool_index || !cond.get<bool>()) {
+				ip = inst.operand;
+			} else {
+				++ip;
+			}
+			break;
+		}
+		case opcode::jump_if_true: {
+			OBJECT cond = visit_object(cast_bool_object {}, stack.back());
+			stack.pop_back();
+			if (cond.index() == bool_index && cond.get<bool>()) {
+				ip = inst.operand;
+			} else {
+				++ip;
+			}
+			break;
+		}
+		case opcode::call: {
+			const bytecode::function_entry& function = program.functions[inst.operand];
+			const code_point& point = program.points[ip];
+			if (!stack.has_headroom()) {
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): stack overflow (" << function.name << ")" << std::endl;
+				con.abort();
+			}
+			size_t base = stack.size() - function.info->arguments.size();
+			size_t bottom = con.reserve_frame(function.info->frame_size);
+			int idx = 0;
+			for (const context::func_info::arg_info& info : function.info->arguments) {
+				OBJECT& value = stack[base + idx];
+				++idx;
+				if (value.index() != static_cast<int>(info.type)) {
+					std::cout << "runtime error (" << point.line << ", " << point.col << "): expected `" << type_names[static_cast<int>(info.type)] << "` actual `" << visit_object(get_object_type_name {}, value) << "` at index: " << idx << std::endl;
+					con.abort();
+				}
+				con.slots[bottom + idx - 1] = context::var_info { .modifier = info.modifier, .type = info.type, .value = std::move(value) };
+			}
+			stack.resize(base);
+			frames.push_back(frame { .return_address = ip + 1, .function = inst.operand, .stack_base = base, .caller_base = con.enter_frame(bottom) });
+			ip = function.entry;
+			break;
+		}
+		case opcode::ret: {
+			OBJECT value = invalid_state();
+			if (inst.operand) {
+				value = std::move(stack.back());
+				stack.pop_back();
+			}
+			if (frames.empty()) {
+				stack.push_back(std::move(value));
+				return;
+			}
+			frame current = frames.back();
+			frames.pop_back();
+			const bytecode::function_entry& function = program.functions[current.function];
+			if (function.info->return_type != visit_object(cast_var_type_object {}, value)) {
+				const code_point& point = program.points[ip];
+				std::cout << "runtime error (" << point.line << ", " << point.col << "): assign different type(expected: `" << type_names[static_cast<int>(function.info->return_type)]
+					<< "`, actual: `" << visit_object(get_object_type_name {}, value) << "`)" << std::endl;
+				con.abort();
+			}
+			con.leave_frame(current.caller_base);
+			stack.resize(current.stack_base);
+			stack.push_back(std::move(value));
+			if (current.return_address < 0) {
+				return;
+			}
+			ip = current.return_address;
+			break;
+		}
+		case opcode::error: {
+			const code_point& point = program.points[ip];
+			std::cout << "runtime error (" << point.line << ", " << point.col << "): " << program.messages[inst.operand] << std::endl;
+			con.abort();
+			return;
+		}
+		case opcode::halt:
+			return;
+		}
+	}
+}